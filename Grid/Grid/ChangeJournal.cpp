@@ -0,0 +1,189 @@
+#include "pch.h"
+#include "ChangeJournal.h"
+#include <algorithm>
+#include <limits.h>
+#include <map>
+
+ChangeJournal::ChangeJournal(int maxFrames, int maxPendingDeltas, int maxStoredDeltas)
+	:MaxFrames(maxFrames)
+	,MaxPendingDeltas(maxPendingDeltas)
+	,MaxStoredDeltas(maxStoredDeltas)
+	,m_Version(0)
+	,m_StoredDeltas(0)
+{
+	ResetPending();
+}
+
+// Repeated edits of a coordinate are coalesced while recording into one delta from its first old
+// to its last new value. Once more than MaxPendingDeltas coordinates changed since the last commit
+// only the dirty rectangle is kept, so uncommitted edits never use more than a bounded amount of memory.
+void ChangeJournal::Record(Coordinate coordinate, int oldValue, int newValue)
+{
+	ExtendPendingRect({ coordinate.X, coordinate.Y, 1, 1 });
+	if (!m_PendingComplete) return;
+
+	auto key = ToKey(coordinate);
+	auto it = m_PendingIndices.find(key);
+	if (it != m_PendingIndices.end())
+	{
+		m_Pending[it->second].NewValue = newValue;
+		return;
+	}
+
+	if ((int)m_Pending.size() >= MaxPendingDeltas)
+	{
+		m_PendingComplete = false;
+		std::vector<CellDelta>().swap(m_Pending);
+		std::unordered_map<unsigned long long, int>().swap(m_PendingIndices);
+		return;
+	}
+
+	m_PendingIndices[key] = (int)m_Pending.size();
+	m_Pending.push_back({ coordinate, oldValue, newValue });
+}
+
+// Records a bulk edit by its bounds only, readers of the frame have to reread the region
+void ChangeJournal::RecordRegion(Rect region)
+{
+	ExtendPendingRect(region);
+	m_PendingComplete = false;
+	std::vector<CellDelta>().swap(m_Pending);
+	std::unordered_map<unsigned long long, int>().swap(m_PendingIndices);
+}
+
+int ChangeJournal::GetRemainingCapacity()
+{
+	return m_PendingComplete ? MaxPendingDeltas - (int)m_Pending.size() : 0;
+}
+
+// Closes the current frame. Deltas that restore the old value are dropped and the version only
+// advances if something changed. Old frames are dropped once there are more than MaxFrames
+// or they hold more than MaxStoredDeltas deltas in total.
+int ChangeJournal::Commit()
+{
+	if (!m_HasPending) return m_Version;
+
+	JournalFrame frame;
+	frame.IsComplete = m_PendingComplete;
+	frame.DirtyRect = { m_PendingMinX, m_PendingMinY, m_PendingMaxX - m_PendingMinX + 1, m_PendingMaxY - m_PendingMinY + 1 };
+	if (frame.IsComplete)
+	{
+		int minX = INT_MAX;
+		int minY = INT_MAX;
+		int maxX = INT_MIN;
+		int maxY = INT_MIN;
+		for (auto& delta : m_Pending)
+		{
+			if (delta.OldValue == delta.NewValue) continue;
+
+			frame.Deltas.push_back(delta);
+			minX = std::min(minX, delta.Position.X);
+			minY = std::min(minY, delta.Position.Y);
+			maxX = std::max(maxX, delta.Position.X);
+			maxY = std::max(maxY, delta.Position.Y);
+		}
+		if (frame.Deltas.empty())
+		{
+			ResetPending();
+			return m_Version;
+		}
+
+		std::sort(frame.Deltas.begin(), frame.Deltas.end(), [](const CellDelta& a, const CellDelta& b) { return a.Position < b.Position; });
+		frame.DirtyRect = { minX, minY, maxX - minX + 1, maxY - minY + 1 };
+	}
+	ResetPending();
+
+	frame.Version = ++m_Version;
+	m_StoredDeltas += (int)frame.Deltas.size();
+	m_Frames.push_back(std::move(frame));
+	while ((int)m_Frames.size() > MaxFrames || (m_StoredDeltas > MaxStoredDeltas && m_Frames.size() > 1))
+	{
+		m_StoredDeltas -= (int)m_Frames.front().Deltas.size();
+		m_Frames.pop_front();
+	}
+	return m_Version;
+}
+
+int ChangeJournal::GetVersion()
+{
+	return m_Version;
+}
+
+// Returns everything committed after the given version. If frames the caller has not seen
+// were already dropped from the journal or only kept their dirty rectangle, NeedsFullResync is set
+// and the caller has to reread the grid, or at least the returned dirty rectangles. Deltas of
+// coordinates that are back at their old value after merging the frames are dropped.
+JournalChanges ChangeJournal::GetChangesSince(int version)
+{
+	JournalChanges changes;
+	changes.Version = m_Version;
+	changes.NeedsFullResync = false;
+	if (version >= m_Version) return changes;
+
+	if (m_Frames.empty() || version < m_Frames.front().Version - 1)
+	{
+		changes.NeedsFullResync = true;
+		return changes;
+	}
+
+	std::map<Coordinate, CellDelta> merged;
+	for (auto& frame : m_Frames)
+	{
+		if (frame.Version <= version) continue;
+
+		changes.DirtyRects.push_back(frame.DirtyRect);
+		if (!frame.IsComplete)
+		{
+			changes.NeedsFullResync = true;
+		}
+		if (changes.NeedsFullResync) continue;
+
+		for (auto& delta : frame.Deltas)
+		{
+			auto it = merged.find(delta.Position);
+			if (it == merged.end())
+			{
+				merged[delta.Position] = delta;
+			}
+			else
+			{
+				it->second.NewValue = delta.NewValue;
+			}
+		}
+	}
+	if (changes.NeedsFullResync) return changes;
+
+	for (auto& entry : merged)
+	{
+		if (entry.second.OldValue == entry.second.NewValue) continue;
+
+		changes.Deltas.push_back(entry.second);
+	}
+	return changes;
+}
+
+unsigned long long ChangeJournal::ToKey(Coordinate coordinate)
+{
+	return ((unsigned long long)(unsigned)coordinate.Y << 32) | (unsigned)coordinate.X;
+}
+
+void ChangeJournal::ExtendPendingRect(Rect region)
+{
+	m_HasPending = true;
+	m_PendingMinX = std::min(m_PendingMinX, region.X);
+	m_PendingMinY = std::min(m_PendingMinY, region.Y);
+	m_PendingMaxX = std::max(m_PendingMaxX, region.X + region.Width - 1);
+	m_PendingMaxY = std::max(m_PendingMaxY, region.Y + region.Height - 1);
+}
+
+void ChangeJournal::ResetPending()
+{
+	m_HasPending = false;
+	m_PendingComplete = true;
+	m_PendingMinX = INT_MAX;
+	m_PendingMinY = INT_MAX;
+	m_PendingMaxX = INT_MIN;
+	m_PendingMaxY = INT_MIN;
+	m_Pending.clear();
+	m_PendingIndices.clear();
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "Structs.h"
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+// IsComplete is false for frames that overflowed the pending limit or held a bulk edit.
+// Those only keep their dirty rectangle, readers have to reread it.
+struct JournalFrame
+{
+	int Version;
+	Rect DirtyRect;
+	bool IsComplete;
+	std::vector<CellDelta> Deltas;
+};
+
+struct JournalChanges
+{
+	int Version;
+	bool NeedsFullResync;
+	std::vector<Rect> DirtyRects;
+	std::vector<CellDelta> Deltas;
+};
+
+class ChangeJournal
+{
+public:
+	ChangeJournal(int maxFrames = 64, int maxPendingDeltas = 1 << 16, int maxStoredDeltas = 1 << 18);
+
+	void Record(Coordinate coordinate, int oldValue, int newValue);
+	void RecordRegion(Rect region);
+	int GetRemainingCapacity();
+	int Commit();
+	int GetVersion();
+	JournalChanges GetChangesSince(int version);
+
+	int MaxFrames;
+	int MaxPendingDeltas;
+	int MaxStoredDeltas;
+
+private:
+	static unsigned long long ToKey(Coordinate coordinate);
+	void ExtendPendingRect(Rect region);
+	void ResetPending();
+
+	int m_Version;
+	bool m_HasPending;
+	bool m_PendingComplete;
+	int m_PendingMinX;
+	int m_PendingMinY;
+	int m_PendingMaxX;
+	int m_PendingMaxY;
+	std::vector<CellDelta> m_Pending;
+	std::unordered_map<unsigned long long, int> m_PendingIndices;
+	std::deque<JournalFrame> m_Frames;
+	int m_StoredDeltas;
+};
@@ -0,0 +1,117 @@
+#include "pch.h"
+#include "ClearanceMap.h"
+#include "Grid.h"
+
+// The clearance of a coordinate is the edge length of the largest square of usable values
+// whose top left corner is the coordinate, so an agent of size n anchored on it covers
+// the coordinates [X, X + n) x [Y, Y + n). Clearances share the padded layout of the value
+// grid, the border stays 0.
+ClearanceMap::ClearanceMap(Grid* valueGrid, std::vector<int> usableValues)
+	:ValueGrid(valueGrid)
+	,UsableValues(usableValues)
+	,m_Stride(valueGrid->Width + 2)
+	,m_UsableValues(usableValues, valueGrid->OutOfBoundsValue)
+{
+	m_Clearance.resize(m_Stride * (valueGrid->Height + 2), 0);
+	Rebuild();
+	ValueGrid->AddObserver(this);
+}
+
+ClearanceMap::~ClearanceMap()
+{
+	if (ValueGrid != nullptr)
+	{
+		ValueGrid->RemoveObserver(this);
+	}
+}
+
+int ClearanceMap::GetClearance(Coordinate coordinate)
+{
+	if (ValueGrid == nullptr
+		|| coordinate.X < 0 || coordinate.X >= ValueGrid->Width
+		|| coordinate.Y < 0 || coordinate.Y >= ValueGrid->Height)
+	{
+		return 0;
+	}
+	return m_Clearance[(coordinate.Y + 1) * m_Stride + coordinate.X + 1];
+}
+
+bool ClearanceMap::Fits(Coordinate coordinate, int agentSize)
+{
+	return GetClearance(coordinate) >= agentSize;
+}
+
+bool ClearanceMap::IsUsableValue(int value)
+{
+	return m_UsableValues.Contains(value);
+}
+
+void ClearanceMap::Rebuild()
+{
+	if (ValueGrid == nullptr) return;
+
+	for (int y = ValueGrid->Height - 1; y >= 0; y--)
+	{
+		for (int x = ValueGrid->Width - 1; x >= 0; x--)
+		{
+			m_Clearance[(y + 1) * m_Stride + x + 1] = ComputeClearance(x, y);
+		}
+	}
+}
+
+void ClearanceMap::OnGridContentChanged(Coordinate coordinate)
+{
+	OnGridRegionChanged({ coordinate.X, coordinate.Y, 1, 1 });
+}
+
+// A changed region can only affect the clearance of coordinates above and left of its bottom right
+// corner. Rows are walked upwards and each row leftwards from the region's right edge. Coordinates
+// inside the region are always recomputed, outside of it the walk stops as soon as neither the right
+// neighbor nor the row below changed, so an edit touches only the area it influences.
+void ClearanceMap::OnGridRegionChanged(Rect region)
+{
+	if (ValueGrid == nullptr) return;
+
+	int right = region.X + region.Width - 1;
+	int bottom = region.Y + region.Height - 1;
+	int belowLo = INT_MAX;
+	for (int y = bottom; y >= 0; y--)
+	{
+		bool isRegionRow = y >= region.Y;
+		int rowLo = INT_MAX;
+		bool rightChanged = false;
+		for (int x = right; x >= 0; x--)
+		{
+			bool isInRegion = isRegionRow && x >= region.X;
+			if (!isInRegion && !rightChanged && x < belowLo - 1) break;
+
+			int newClearance = ComputeClearance(x, y);
+			int& clearance = m_Clearance[(y + 1) * m_Stride + x + 1];
+			rightChanged = newClearance != clearance;
+			if (rightChanged)
+			{
+				clearance = newClearance;
+				rowLo = x;
+			}
+		}
+		if (rowLo == INT_MAX && y <= region.Y) break;
+		belowLo = rowLo;
+	}
+}
+
+void ClearanceMap::DetachGrid()
+{
+	ValueGrid = nullptr;
+	m_Clearance.clear();
+}
+
+int ClearanceMap::ComputeClearance(int x, int y)
+{
+	if (!IsUsableValue(ValueGrid->GetGridContent({ x, y }))) return 0;
+
+	int idx = (y + 1) * m_Stride + x + 1;
+	int right = m_Clearance[idx + 1];
+	int bottom = m_Clearance[idx + m_Stride];
+	int diagonal = m_Clearance[idx + m_Stride + 1];
+	return 1 + std::min(right, std::min(bottom, diagonal));
+}
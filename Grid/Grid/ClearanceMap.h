@@ -0,0 +1,39 @@
+#pragma once
+#include "GridObserver.h"
+#include "Structs.h"
+#include "ValueSet.h"
+#include <vector>
+
+class Grid;
+
+class ClearanceMap : public GridObserver
+{
+public:
+	ClearanceMap(Grid* valueGrid, std::vector<int> usableValues);
+	~ClearanceMap();
+
+	int GetClearance(Coordinate coordinate);
+	bool Fits(Coordinate coordinate, int agentSize);
+	bool IsUsableValue(int value);
+
+	// Clearance by index into the value grid's padded storage, used by the search's inner loop
+	int GetClearance(int gridIdx) const
+	{
+		return m_Clearance[gridIdx];
+	}
+
+	void Rebuild();
+	void OnGridContentChanged(Coordinate coordinate) override;
+	void OnGridRegionChanged(Rect region) override;
+	void DetachGrid() override;
+
+	Grid* ValueGrid;
+	std::vector<int> UsableValues;
+
+private:
+	int ComputeClearance(int x, int y);
+
+	int m_Stride;
+	ValueSet m_UsableValues;
+	std::vector<int> m_Clearance;
+};
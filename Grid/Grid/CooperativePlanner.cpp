@@ -0,0 +1,254 @@
+#include "pch.h"
+#include "CooperativePlanner.h"
+#include "Grid.h"
+#include <algorithm>
+#include <cstdlib>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+	struct SpaceTimeNode
+	{
+		Coordinate Position;
+		int Step;
+		float Cost;
+		int Parent;
+	};
+
+	struct SpaceTimeEntry
+	{
+		float Priority;
+		int Node;
+
+		bool operator>(const SpaceTimeEntry& other) const
+		{
+			return Priority > other.Priority;
+		}
+	};
+}
+
+CooperativePlanner::CooperativePlanner(Grid* costGrid, int window, bool useCost)
+	:CostGrid(costGrid)
+	,Window(window)
+	,UseCost(useCost)
+	,CurrentTimestep(0)
+	,IsValid(window >= 0)
+	,m_UseTypeInfo(false)
+	,m_TypeInfo{ {}, nullptr }
+	,m_UsableValues({}, costGrid->OutOfBoundsValue)
+{}
+
+CooperativePlanner::CooperativePlanner(Grid* costGrid, int window, bool useCost, AStarValueInfo typeInfo)
+	:CostGrid(costGrid)
+	,Window(window)
+	,UseCost(useCost)
+	,CurrentTimestep(0)
+	,IsValid(window >= 0
+		&& typeInfo.ValueGrid != nullptr
+		&& typeInfo.ValueGrid->Width == costGrid->Width
+		&& typeInfo.ValueGrid->Height == costGrid->Height)
+	,m_UseTypeInfo(true)
+	,m_TypeInfo(typeInfo)
+	,m_UsableValues(typeInfo.UseableValues, typeInfo.ValueGrid != nullptr ? typeInfo.ValueGrid->OutOfBoundsValue : INT_MIN)
+{}
+
+std::vector<Coordinate> CooperativePlanner::PlanPath(CooperativeAgent agent)
+{
+	bool isBoxedIn;
+	return PlanPath(agent, isBoxedIn);
+}
+
+// Agents that end up boxed in by the reservations of earlier agents are pinned: on the next
+// attempt they reserve their coordinate for the whole window before anyone else is planned,
+// so the others have to go around them. Pinned agents can't be boxed in, so this terminates.
+std::vector<std::vector<Coordinate>> CooperativePlanner::PlanPaths(const std::vector<CooperativeAgent>& agents)
+{
+	std::vector<std::vector<Coordinate>> paths(agents.size());
+	std::vector<bool> pinned(agents.size(), false);
+	bool anyBoxedIn = true;
+	while (anyBoxedIn)
+	{
+		anyBoxedIn = false;
+		for (auto& agent : agents)
+		{
+			m_Reservations.ReleaseAgent(agent.Id);
+		}
+
+		for (int i = 0; i < (int)agents.size(); i++)
+		{
+			if (!pinned[i]) continue;
+
+			for (int step = 0; step <= Window; step++)
+			{
+				m_Reservations.Reserve(ToCell(agents[i].Start), CurrentTimestep + step, agents[i].Id);
+			}
+			paths[i] = { agents[i].Start };
+		}
+
+		for (int i = 0; i < (int)agents.size() && !anyBoxedIn; i++)
+		{
+			if (pinned[i]) continue;
+
+			bool isBoxedIn;
+			paths[i] = PlanPath(agents[i], isBoxedIn);
+			if (isBoxedIn)
+			{
+				pinned[i] = true;
+				anyBoxedIn = true;
+			}
+		}
+	}
+	return paths;
+}
+
+// Returns one coordinate per timestep starting at the agent's start on the current timestep.
+// Waiting shows up as the same coordinate on consecutive timesteps.
+std::vector<Coordinate> CooperativePlanner::PlanPath(CooperativeAgent agent, bool& isBoxedIn)
+{
+	std::vector<Coordinate> path;
+	isBoxedIn = false;
+	m_Reservations.ReleaseAgent(agent.Id);
+	if (!IsValid || !CostGrid->IsInBounds(agent.Start) || !IsWalkable(agent.Start)) return path;
+
+	std::vector<SpaceTimeNode> nodes;
+	std::unordered_map<long long, float> bestCosts;
+	std::priority_queue<SpaceTimeEntry, std::vector<SpaceTimeEntry>, std::greater<SpaceTimeEntry>> coordsToCheck;
+	long long cellCount = (long long)CostGrid->Width * CostGrid->Height;
+
+	auto heuristic = [&](Coordinate coordinate)
+	{
+		return (float)(abs(agent.End.X - coordinate.X) + abs(agent.End.Y - coordinate.Y));
+	};
+
+	nodes.push_back({ agent.Start, 0, 0, -1 });
+	bestCosts[ToCell(agent.Start)] = 0;
+	coordsToCheck.push({ heuristic(agent.Start), 0 });
+
+	int found = -1;
+	while (!coordsToCheck.empty())
+	{
+		auto entry = coordsToCheck.top();
+		coordsToCheck.pop();
+		auto current = nodes[entry.Node];
+		long long currentKey = current.Step * cellCount + ToCell(current.Position);
+		if (current.Cost > bestCosts[currentKey]) continue;
+
+		if ((current.Position == agent.End && CanStayUntilWindowEnd(current.Position, current.Step, agent.Id))
+			|| current.Step == Window)
+		{
+			found = entry.Node;
+			break;
+		}
+
+		// Directions 0 to 3 are the orthogonal neighbors, direction 4 waits in place
+		for (int direction = 0; direction <= 4; direction++)
+		{
+			Coordinate neighbor = direction < 4
+				? Coordinate{ current.Position.X + NeighborOffsets::X[direction], current.Position.Y + NeighborOffsets::Y[direction] }
+				: current.Position;
+			if (!CostGrid->IsInBounds(neighbor) || !IsWalkable(neighbor)) continue;
+			if (!CanMove(current.Position, neighbor, current.Step, agent.Id)) continue;
+
+			auto newCost = current.Cost + (UseCost ? CostGrid->GetGridContent(neighbor) : 1);
+			long long key = (current.Step + 1) * cellCount + ToCell(neighbor);
+			auto it = bestCosts.find(key);
+			if (it != bestCosts.end() && !(newCost < it->second)) continue;
+			bestCosts[key] = newCost;
+
+			nodes.push_back({ neighbor, current.Step + 1, newCost, entry.Node });
+			coordsToCheck.push({ newCost + heuristic(neighbor), (int)nodes.size() - 1 });
+		}
+	}
+
+	if (found == -1)
+	{
+		// Boxed in by other agents, wait in place and try again on the next plan
+		isBoxedIn = true;
+		for (int step = 0; step <= Window; step++)
+		{
+			m_Reservations.Reserve(ToCell(agent.Start), CurrentTimestep + step, agent.Id);
+		}
+		path.push_back(agent.Start);
+		return path;
+	}
+
+	for (int node = found; node != -1; node = nodes[node].Parent)
+	{
+		path.push_back(nodes[node].Position);
+	}
+	std::reverse(path.begin(), path.end());
+
+	for (int step = 0; step < (int)path.size(); step++)
+	{
+		m_Reservations.Reserve(ToCell(path[step]), CurrentTimestep + step, agent.Id);
+	}
+
+	auto last = path.back();
+	if (last == agent.End)
+	{
+		for (int step = (int)path.size(); step <= Window; step++)
+		{
+			m_Reservations.Reserve(ToCell(last), CurrentTimestep + step, agent.Id);
+		}
+		return path;
+	}
+
+	auto remainder = m_UseTypeInfo
+		? CostGrid->AStarSearch(last, agent.End, UseCost, m_TypeInfo)
+		: CostGrid->AStarSearch(last, agent.End, UseCost);
+	for (int i = (int)remainder.size() - 2; i >= 0; i--)
+	{
+		path.push_back(remainder[i]);
+	}
+	return path;
+}
+
+void CooperativePlanner::Advance(int timesteps)
+{
+	CurrentTimestep += timesteps;
+	m_Reservations.ReleaseBefore(CurrentTimestep);
+}
+
+void CooperativePlanner::ReleaseAgent(int agentId)
+{
+	m_Reservations.ReleaseAgent(agentId);
+}
+
+// Matches the walkability of Grid::AStarSearch, which plans the remainder after the window
+bool CooperativePlanner::IsWalkable(Coordinate coordinate)
+{
+	if (!m_UseTypeInfo) return CostGrid->GetGridContent(coordinate) != CostGrid->OutOfBoundsValue;
+	return m_UsableValues.Contains(m_TypeInfo.ValueGrid->GetGridContent(coordinate));
+}
+
+// Moving from one coordinate to another between step and step + 1 needs the target to be free on
+// step + 1 and must not swap places with an agent moving the opposite way.
+bool CooperativePlanner::CanMove(Coordinate from, Coordinate to, int step, int agentId)
+{
+	int toCell = ToCell(to);
+	int timestep = CurrentTimestep + step;
+	if (m_Reservations.IsReservedByOther(toCell, timestep + 1, agentId)) return false;
+	if (from == to) return true;
+
+	int fromCell = ToCell(from);
+	int owner = m_Reservations.GetOwner(toCell, timestep);
+	return owner == ReservationTable::NoAgent
+		|| owner == agentId
+		|| m_Reservations.GetOwner(fromCell, timestep + 1) != owner;
+}
+
+bool CooperativePlanner::CanStayUntilWindowEnd(Coordinate coordinate, int step, int agentId)
+{
+	int cell = ToCell(coordinate);
+	for (int s = step + 1; s <= Window; s++)
+	{
+		if (m_Reservations.IsReservedByOther(cell, CurrentTimestep + s, agentId)) return false;
+	}
+	return true;
+}
+
+int CooperativePlanner::ToCell(Coordinate coordinate)
+{
+	return coordinate.Y * CostGrid->Width + coordinate.X;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "ReservationTable.h"
+#include "Structs.h"
+#include "ValueSet.h"
+#include <vector>
+
+class Grid;
+
+struct CooperativeAgent
+{
+	int Id;
+	Coordinate Start;
+	Coordinate End;
+};
+
+// Windowed cooperative A*: agents are planned one after another through space and
+// time, each one avoiding the (cell, timestep) pairs reserved by the agents planned before it.
+// Only the first Window timesteps of a path are reserved, the remainder is a regular A* path
+// that gets replaced when the agent is planned again. The heuristic is the Manhattan distance.
+class CooperativePlanner
+{
+public:
+	CooperativePlanner(Grid* costGrid, int window, bool useCost);
+	CooperativePlanner(Grid* costGrid, int window, bool useCost, AStarValueInfo typeInfo);
+
+	std::vector<Coordinate> PlanPath(CooperativeAgent agent);
+	std::vector<std::vector<Coordinate>> PlanPaths(const std::vector<CooperativeAgent>& agents);
+
+	void Advance(int timesteps);
+	void ReleaseAgent(int agentId);
+
+	Grid* CostGrid;
+	int Window;
+	bool UseCost;
+	int CurrentTimestep;
+	bool IsValid;
+
+private:
+	std::vector<Coordinate> PlanPath(CooperativeAgent agent, bool& isBoxedIn);
+	bool IsWalkable(Coordinate coordinate);
+	bool CanMove(Coordinate from, Coordinate to, int step, int agentId);
+	bool CanStayUntilWindowEnd(Coordinate coordinate, int step, int agentId);
+	int ToCell(Coordinate coordinate);
+
+	bool m_UseTypeInfo;
+	AStarValueInfo m_TypeInfo;
+	ValueSet m_UsableValues;
+	ReservationTable m_Reservations;
+};
@@ -65,17 +65,69 @@ int* Extern::GetRandomCoordinateOfValue(int* grid, int value)
 	return retVal;
 }
 
+int Extern::CountValue(int* grid, int value, bool parallel)
+{
+	Grid* g = (Grid*)grid;
+	return g->CountValue(value, parallel);
+}
+
+int Extern::CountValueInRegion(int* grid, int value, int x, int y, int width, int height, bool parallel)
+{
+	Grid* g = (Grid*)grid;
+	return g->CountValue(value, { x, y, width, height }, parallel);
+}
+
+int* Extern::FindValue(int* grid, int value, bool parallel)
+{
+	Grid* g = (Grid*)grid;
+	auto vec = g->FindValue(value, parallel);
+
+	auto retVal = new int[vec.size() * 2 + 1];
+	retVal[0] = vec.size();
+	for (auto i = 0; i < vec.size(); i++)
+	{
+		retVal[i * 2 + 1] = vec[i].X;
+		retVal[i * 2 + 2] = vec[i].Y;
+	}
+
+	return retVal;
+}
+
+int* Extern::FindValueInRegion(int* grid, int value, int x, int y, int width, int height, bool parallel)
+{
+	Grid* g = (Grid*)grid;
+	auto vec = g->FindValue(value, { x, y, width, height }, parallel);
+
+	auto retVal = new int[vec.size() * 2 + 1];
+	retVal[0] = vec.size();
+	for (auto i = 0; i < vec.size(); i++)
+	{
+		retVal[i * 2 + 1] = vec[i].X;
+		retVal[i * 2 + 2] = vec[i].Y;
+	}
+
+	return retVal;
+}
+
+int Extern::ReplaceValue(int* grid, int from, int to, bool parallel)
+{
+	Grid* g = (Grid*)grid;
+	return g->ReplaceValue(from, to, parallel);
+}
+
+int Extern::ReplaceValueInRegion(int* grid, int from, int to, int x, int y, int width, int height, bool parallel)
+{
+	Grid* g = (Grid*)grid;
+	return g->ReplaceValue(from, to, { x, y, width, height }, parallel);
+}
+
 int* Extern::GetAdjacentValues(int* grid, int x, int y)
 {
 	Coordinate coord{ x,y };
 	Grid* g = (Grid*)grid;
-	auto values = g->GetAdjacentValues(coord);
 	
 	int* retVal = new int[4];
-	retVal[0] = values[0];
-	retVal[1] = values[1];
-	retVal[2] = values[2];
-	retVal[3] = values[3];
+	g->GetAdjacentValues(coord, retVal);
 	
 	return retVal;
 }
@@ -167,6 +219,351 @@ int* Extern::AStarSearchWithTypeInfo(int* grid, int startX, int startY, int endX
 	return retVal;
 }
 
+int* Extern::AStarSearchWithConnectivity(int* grid, int startX, int startY, int endX, int endY, bool useCost, int connectivity)
+{
+	Coordinate start{ startX,startY };
+	Coordinate end{ endX,endY };
+	Grid* g = (Grid*)grid;
+	auto vec = g->AStarSearch(start, end, useCost, (Connectivity)connectivity);
+
+	auto retVal = new int[vec.size() * 2 + 1];
+	retVal[0] = vec.size();
+	for (auto i = 0; i < vec.size(); i++)
+	{
+		retVal[i * 2 + 1] = vec[i].X;
+		retVal[i * 2 + 2] = vec[i].Y;
+	}
+
+	return retVal;
+}
+
+int* Extern::AStarSearchWithTypeInfoAndConnectivity(int* grid, int startX, int startY, int endX, int endY, bool useCost, int* usableValues, int* valueGrid, int connectivity)
+{
+	Coordinate start{ startX,startY };
+	Coordinate end{ endX,endY };
+	Grid* g = (Grid*)grid;
+	Grid* vG = (Grid*)valueGrid;
+
+	auto size = usableValues[0];
+	std::vector<int> valueVec;
+	for (auto i = 1; i < size + 1; i++)
+	{
+		valueVec.push_back(usableValues[i]);
+	}
+	AStarValueInfo info {valueVec,vG};
+
+	auto vec = g->AStarSearch(start, end, useCost, info, (Connectivity)connectivity);
+
+	auto retVal = new int[vec.size() * 2 + 1];
+	retVal[0] = vec.size();
+	for (auto i = 0; i < vec.size(); i++)
+	{
+		retVal[i * 2 + 1] = vec[i].X;
+		retVal[i * 2 + 2] = vec[i].Y;
+	}
+
+	return retVal;
+}
+
+void Extern::ReleaseSearchBuffers()
+{
+	Grid::ReleaseSearchBuffers();
+}
+
+int* Extern::SimplifyPath(int* path)
+{
+	auto size = path[0];
+	std::vector<Coordinate> pathVec;
+	for (auto i = 0; i < size; i++)
+	{
+		pathVec.push_back({ path[i * 2 + 1], path[i * 2 + 2] });
+	}
+
+	auto vec = Grid::SimplifyPath(pathVec);
+
+	auto retVal = new int[vec.size() * 2 + 1];
+	retVal[0] = vec.size();
+	for (auto i = 0; i < vec.size(); i++)
+	{
+		retVal[i * 2 + 1] = vec[i].X;
+		retVal[i * 2 + 2] = vec[i].Y;
+	}
+
+	return retVal;
+}
+
+int* Extern::StringPullPath(int* path, int* usableValues, int* valueGrid)
+{
+	Grid* vG = (Grid*)valueGrid;
+
+	auto size = path[0];
+	std::vector<Coordinate> pathVec;
+	for (auto i = 0; i < size; i++)
+	{
+		pathVec.push_back({ path[i * 2 + 1], path[i * 2 + 2] });
+	}
+
+	auto valueSize = usableValues[0];
+	std::vector<int> valueVec;
+	for (auto i = 1; i < valueSize + 1; i++)
+	{
+		valueVec.push_back(usableValues[i]);
+	}
+
+	auto vec = vG->StringPullPath(pathVec, valueVec);
+
+	auto retVal = new int[vec.size() * 2 + 1];
+	retVal[0] = vec.size();
+	for (auto i = 0; i < vec.size(); i++)
+	{
+		retVal[i * 2 + 1] = vec[i].X;
+		retVal[i * 2 + 2] = vec[i].Y;
+	}
+
+	return retVal;
+}
+
+int Extern::CommitGridChanges(int* grid)
+{
+	Grid* g = (Grid*)grid;
+	return g->CommitChanges();
+}
+
+int Extern::GetGridVersion(int* grid)
+{
+	Grid* g = (Grid*)grid;
+	return g->GetVersion();
+}
+
+int* Extern::GetGridChangesSince(int* grid, int version)
+{
+	Grid* g = (Grid*)grid;
+	auto changes = g->GetChangesSince(version);
+
+	auto rectsOffset = 3;
+	auto deltasOffset = rectsOffset + changes.DirtyRects.size() * 4;
+	auto retVal = new int[deltasOffset + 1 + changes.Deltas.size() * 3];
+	retVal[0] = changes.Version;
+	retVal[1] = changes.NeedsFullResync ? 1 : 0;
+	retVal[2] = changes.DirtyRects.size();
+	for (auto i = 0; i < changes.DirtyRects.size(); i++)
+	{
+		retVal[rectsOffset + i * 4] = changes.DirtyRects[i].X;
+		retVal[rectsOffset + i * 4 + 1] = changes.DirtyRects[i].Y;
+		retVal[rectsOffset + i * 4 + 2] = changes.DirtyRects[i].Width;
+		retVal[rectsOffset + i * 4 + 3] = changes.DirtyRects[i].Height;
+	}
+	retVal[deltasOffset] = changes.Deltas.size();
+	for (auto i = 0; i < changes.Deltas.size(); i++)
+	{
+		retVal[deltasOffset + i * 3 + 1] = changes.Deltas[i].Position.X;
+		retVal[deltasOffset + i * 3 + 2] = changes.Deltas[i].Position.Y;
+		retVal[deltasOffset + i * 3 + 3] = changes.Deltas[i].NewValue;
+	}
+
+	return retVal;
+}
+
+int* Extern::CreateClearanceMap(int* valueGrid, int* usableValues)
+{
+	Grid* vG = (Grid*)valueGrid;
+
+	auto size = usableValues[0];
+	std::vector<int> valueVec;
+	for (auto i = 1; i < size + 1; i++)
+	{
+		valueVec.push_back(usableValues[i]);
+	}
+
+	auto clearanceMap = new ClearanceMap(vG, valueVec);
+	int* retVal = (int*)clearanceMap;
+	return retVal;
+}
+
+void Extern::DeleteClearanceMap(int* clearanceMap)
+{
+	ClearanceMap* cM = (ClearanceMap*)clearanceMap;
+	delete cM;
+}
+
+int Extern::GetClearance(int* clearanceMap, int x, int y)
+{
+	Coordinate coord{ x,y };
+	ClearanceMap* cM = (ClearanceMap*)clearanceMap;
+	return cM->GetClearance(coord);
+}
+
+int* Extern::AStarSearchWithClearance(int* grid, int startX, int startY, int endX, int endY, bool useCost, int* clearanceMap, int agentSize, int connectivity)
+{
+	Coordinate start{ startX,startY };
+	Coordinate end{ endX,endY };
+	Grid* g = (Grid*)grid;
+	ClearanceMap* cM = (ClearanceMap*)clearanceMap;
+
+	auto vec = g->AStarSearch(start, end, useCost, cM, agentSize, (Connectivity)connectivity);
+
+	auto retVal = new int[vec.size() * 2 + 1];
+	retVal[0] = vec.size();
+	for (auto i = 0; i < vec.size(); i++)
+	{
+		retVal[i * 2 + 1] = vec[i].X;
+		retVal[i * 2 + 2] = vec[i].Y;
+	}
+
+	return retVal;
+}
+
+int* Extern::CreateSummedAreaTable(int* grid)
+{
+	Grid* g = (Grid*)grid;
+	auto summedAreaTable = new SummedAreaTable(g);
+	int* retVal = (int*)summedAreaTable;
+	return retVal;
+}
+
+void Extern::DeleteSummedAreaTable(int* summedAreaTable)
+{
+	SummedAreaTable* sAT = (SummedAreaTable*)summedAreaTable;
+	delete sAT;
+}
+
+long long Extern::GetRegionSum(int* summedAreaTable, int x, int y, int width, int height)
+{
+	SummedAreaTable* sAT = (SummedAreaTable*)summedAreaTable;
+	return sAT->GetSum(x, y, width, height);
+}
+
+float Extern::GetRegionMean(int* summedAreaTable, int x, int y, int width, int height)
+{
+	SummedAreaTable* sAT = (SummedAreaTable*)summedAreaTable;
+	return sAT->GetMean(x, y, width, height);
+}
+
+int Extern::GetRegionCount(int* summedAreaTable, int x, int y, int width, int height)
+{
+	SummedAreaTable* sAT = (SummedAreaTable*)summedAreaTable;
+	return sAT->GetCount(x, y, width, height);
+}
+
+int Extern::GetRegionSetCount(int* summedAreaTable, int x, int y, int width, int height)
+{
+	SummedAreaTable* sAT = (SummedAreaTable*)summedAreaTable;
+	return sAT->GetSetCount(x, y, width, height);
+}
+
+void Extern::GetRegionSums(int* summedAreaTable, int* rects, long long* sums)
+{
+	SummedAreaTable* sAT = (SummedAreaTable*)summedAreaTable;
+
+	auto size = rects[0];
+	for (auto i = 0; i < size; i++)
+	{
+		int* rect = rects + 1 + i * 4;
+		sums[i] = sAT->GetSum(rect[0], rect[1], rect[2], rect[3]);
+	}
+}
+
+void Extern::GetRegionMeans(int* summedAreaTable, int* rects, float* means)
+{
+	SummedAreaTable* sAT = (SummedAreaTable*)summedAreaTable;
+
+	auto size = rects[0];
+	for (auto i = 0; i < size; i++)
+	{
+		int* rect = rects + 1 + i * 4;
+		means[i] = sAT->GetMean(rect[0], rect[1], rect[2], rect[3]);
+	}
+}
+
+void Extern::GetRegionSetCounts(int* summedAreaTable, int* rects, int* setCounts)
+{
+	SummedAreaTable* sAT = (SummedAreaTable*)summedAreaTable;
+
+	auto size = rects[0];
+	for (auto i = 0; i < size; i++)
+	{
+		int* rect = rects + 1 + i * 4;
+		setCounts[i] = sAT->GetSetCount(rect[0], rect[1], rect[2], rect[3]);
+	}
+}
+
+int* Extern::CreateCooperativePlanner(int* grid, int window, bool useCost, int* usableValues, int* valueGrid)
+{
+	Grid* g = (Grid*)grid;
+	if (usableValues == nullptr)
+	{
+		return (int*)new CooperativePlanner(g, window, useCost);
+	}
+
+	Grid* vG = (Grid*)valueGrid;
+
+	auto size = usableValues[0];
+	std::vector<int> valueVec;
+	for (auto i = 1; i < size + 1; i++)
+	{
+		valueVec.push_back(usableValues[i]);
+	}
+	AStarValueInfo info {valueVec,vG};
+
+	auto planner = new CooperativePlanner(g, window, useCost, info);
+	int* retVal = (int*)planner;
+	return retVal;
+}
+
+void Extern::DeleteCooperativePlanner(int* planner)
+{
+	CooperativePlanner* cP = (CooperativePlanner*)planner;
+	delete cP;
+}
+
+int* Extern::PlanCooperativePaths(int* planner, int* agents)
+{
+	CooperativePlanner* cP = (CooperativePlanner*)planner;
+
+	auto size = agents[0];
+	std::vector<CooperativeAgent> agentVec;
+	for (auto i = 0; i < size; i++)
+	{
+		int* agent = agents + 1 + i * 5;
+		agentVec.push_back({ agent[0], { agent[1], agent[2] }, { agent[3], agent[4] } });
+	}
+
+	auto paths = cP->PlanPaths(agentVec);
+
+	auto retValSize = 1;
+	for (auto& path : paths)
+	{
+		retValSize += 2 + path.size() * 2;
+	}
+	auto retVal = new int[retValSize];
+	retVal[0] = paths.size();
+	auto pos = 1;
+	for (auto i = 0; i < paths.size(); i++)
+	{
+		retVal[pos++] = agentVec[i].Id;
+		retVal[pos++] = paths[i].size();
+		for (auto& coord : paths[i])
+		{
+			retVal[pos++] = coord.X;
+			retVal[pos++] = coord.Y;
+		}
+	}
+
+	return retVal;
+}
+
+void Extern::AdvanceCooperativePlanner(int* planner, int timesteps)
+{
+	CooperativePlanner* cP = (CooperativePlanner*)planner;
+	cP->Advance(timesteps);
+}
+
+void Extern::ReleaseCooperativeAgent(int* planner, int agentId)
+{
+	CooperativePlanner* cP = (CooperativePlanner*)planner;
+	cP->ReleaseAgent(agentId);
+}
+
 void Extern::DeleteArray(int* arr)
 {
 	delete[] arr;
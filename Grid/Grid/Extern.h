@@ -1,5 +1,8 @@
 #pragma once
 #include "Grid.h"
+#include "ClearanceMap.h"
+#include "CooperativePlanner.h"
+#include "SummedAreaTable.h"
 
 #ifdef _EXPORTING
 #define dllFunc __declspec(dllexport)
@@ -62,6 +65,43 @@ namespace Extern
 		/// </summary>
 		dllFunc int* GetRandomCoordinateOfValue(int* grid, int value);
 
+		/// <summary>
+		/// Casts the given int* into a Grid* and returns the number of coordinates holding the given value.
+		/// With parallel set large grids are scanned on multiple threads.
+		/// </summary>
+		dllFunc int CountValue(int* grid, int value, bool parallel);
+
+		/// <summary>
+		/// Casts the given int* into a Grid* and returns the number of coordinates holding the given value inside the given rectangle.
+		/// The rectangle is clipped to the bounds of the grid, with parallel set large rectangles are scanned on multiple threads.
+		/// </summary>
+		dllFunc int CountValueInRegion(int* grid, int value, int x, int y, int width, int height, bool parallel);
+
+		/// <summary>
+		/// Casts the given int* into a Grid* and returns an int* with all coordinates holding the given value, ordered row by row. The int* is structured as follows:
+		/// [0] = Num of coordinates
+		/// [1] = X Coordinate of 1. coordinate
+		/// [2] = Y Coordinate of 1. coordinate
+		/// Repeat [1]&[2] for each coordinate
+		/// </summary>
+		dllFunc int* FindValue(int* grid, int value, bool parallel);
+
+		/// <summary>
+		/// Same as FindValue but only searches inside the given rectangle, which is clipped to the bounds of the grid
+		/// </summary>
+		dllFunc int* FindValueInRegion(int* grid, int value, int x, int y, int width, int height, bool parallel);
+
+		/// <summary>
+		/// Casts the given int* into a Grid* and sets every coordinate holding the value from to the value to. Returns the number of changed coordinates.
+		/// The changes are recorded in the change journal and clearance maps and summed area tables of the grid are updated.
+		/// </summary>
+		dllFunc int ReplaceValue(int* grid, int from, int to, bool parallel);
+
+		/// <summary>
+		/// Same as ReplaceValue but only replaces inside the given rectangle, which is clipped to the bounds of the grid
+		/// </summary>
+		dllFunc int ReplaceValueInRegion(int* grid, int from, int to, int x, int y, int width, int height, bool parallel);
+
 		/// <summary>
 		/// Casts the given int* into a Grid* and returns an int* with adjaciant values. The int* is structured as follows:
 		/// {LEFT,TOP,RIGHT,BOTTOM}
@@ -103,7 +143,201 @@ namespace Extern
 		/// Repeat [1]&[2] for each Coordinate on the path
 		/// </summary>
 		dllFunc int* AStarSearchWithTypeInfo(int* grid, int startX, int startY, int endX, int endY, bool useCost, int* usebleValues, int* valueGrid);
+
+		/// <summary>
+		/// Same as AStarSearch but moves between coordinates with the given connectivity:
+		/// 0 = 4-connected, 1 = 8-connected, 2 = 8-connected without cutting corners of unusable coordinates.
+		/// Diagonal steps cost sqrt(2) times the value of the entered coordinate.
+		/// </summary>
+		dllFunc int* AStarSearchWithConnectivity(int* grid, int startX, int startY, int endX, int endY, bool useCost, int connectivity);
+
+		/// <summary>
+		/// Same as AStarSearchWithTypeInfo but moves between coordinates with the given connectivity:
+		/// 0 = 4-connected, 1 = 8-connected, 2 = 8-connected without cutting corners of unusable coordinates.
+		/// Diagonal steps cost sqrt(2) times the value of the entered coordinate.
+		/// </summary>
+		dllFunc int* AStarSearchWithTypeInfoAndConnectivity(int* grid, int startX, int startY, int endX, int endY, bool useCost, int* usebleValues, int* valueGrid, int connectivity);
+
+		/// <summary>
+		/// Frees the search buffers of the calling thread. Every thread keeps buffers sized for the largest grid it searched,
+		/// 12 bytes per coordinate, so searches can run concurrently on one grid. The next search on the thread allocates them again.
+		/// </summary>
+		dllFunc void ReleaseSearchBuffers();
+
+		/// <summary>
+		/// Returns an int* with the given path reduced to its corner waypoints: the first and last coordinate and every coordinate where the direction changes.
+		/// path and the returned int* are structured like the result of AStarSearch, path is not deleted.
+		/// </summary>
+		dllFunc int* SimplifyPath(int* path);
+
+		/// <summary>
+		/// Casts the given int* into a Grid* and returns an int* with the given path reduced to waypoints with a straight line of sight between each other.
+		/// A line of sight only crosses coordinates of the value grid with one of the usable values.
+		/// path and the returned int* are structured like the result of AStarSearch, path is not deleted.
+		/// </summary>
+		/// <param name="usableValues">Values a line of sight may cross, structured as [0] = Num of values, [1..n] = values</param>
+		dllFunc int* StringPullPath(int* path, int* usableValues, int* valueGrid);
+
+		/// <summary>
+		/// Casts the given int* into a Grid* and closes the current frame of its change journal.
+		/// All edits since the last commit are coalesced into one journal entry. Returns the grid's version afterwards,
+		/// which only advances if the commit contained at least one changed coordinate.
+		/// </summary>
+		dllFunc int CommitGridChanges(int* grid);
+
+		/// <summary>
+		/// Casts the given int* into a Grid* and returns the version of its last committed change
+		/// </summary>
+		dllFunc int GetGridVersion(int* grid);
+
+		/// <summary>
+		/// Casts the given int* into a Grid* and returns an int* with all changes committed after the given version. The int* is structured as follows:
+		/// [0] = Current version of the grid
+		/// [1] = 1 if the journal doesn't hold every changed coordinate since the given version, otherwise 0.
+		/// The coordinates inside the returned dirty rectangles have to be reread then, or the whole grid if no rectangles are returned.
+		/// No coordinates are returned in this case
+		/// [2] = Num of dirty rectangles
+		/// [3] = X, [4] = Y, [5] = Width, [6] = Height of the 1. dirty rectangle
+		/// Repeat [3]-[6] for each dirty rectangle
+		/// [n] = Num of changed coordinates
+		/// [n+1] = X coordinate, [n+2] = Y coordinate, [n+3] = new value of the 1. changed coordinate
+		/// Repeat [n+1]-[n+3] for each changed coordinate
+		/// </summary>
+		dllFunc int* GetGridChangesSince(int* grid, int version);
+
+		/// <summary>
+		/// Creates a pointer to a clearance map over the given value grid and casts it into an int*.
+		/// The clearance of a coordinate is the size of the largest square of usable values that has the coordinate as its top left corner.
+		/// The map is kept up to date whenever content is set on the value grid.
+		/// </summary>
+		/// <param name="valueGrid">Grid the clearance is computed on</param>
+		/// <param name="usableValues">Values an agent may stand on, structured as [0] = Num of values, [1..n] = values</param>
+		dllFunc int* CreateClearanceMap(int* valueGrid, int* usableValues);
+
+		/// <summary>
+		/// Casts the given int* into a ClearanceMap* and deletes it
+		/// </summary>
+		dllFunc void DeleteClearanceMap(int* clearanceMap);
+
+		/// <summary>
+		/// Casts the given int* into a ClearanceMap* and returns the clearance of the given coordinate
+		/// </summary>
+		dllFunc int GetClearance(int* clearanceMap, int x, int y);
+
+		/// <summary>
+		/// Casts the given int* into a Grid* and returns an int* with coordinates on a path from start to end for an agent covering agentSize x agentSize cells.
+		/// Coordinates on the path are the top left corner of the agent's footprint, every coordinate on the path has a clearance of at least agentSize.
+		/// Returns an empty path if agentSize is smaller than 1.
+		/// Moves between coordinates with the given connectivity like AStarSearchWithConnectivity:
+		/// 0 = 4-connected, 1 = 8-connected, 2 = 8-connected without cutting corners of unusable coordinates.
+		/// The int* is structured as follows:
+		/// [0] = Num of coordinates on path
+		/// [1] = X coordinate of 1. Coordinate on the path
+		/// [2] = Y coordinate of 1. Coordinate on the path
+		/// Repeat [1]&[2] for each Coordinate on the path
+		/// </summary>
+		dllFunc int* AStarSearchWithClearance(int* grid, int startX, int startY, int endX, int endY, bool useCost, int* clearanceMap, int agentSize, int connectivity);
 	
+		/// <summary>
+		/// Creates a pointer to a summed area table over the given grid and casts it into an int*.
+		/// Edits on the grid mark the table dirty, it is rebuilt from the first changed row on the next query.
+		/// </summary>
+		dllFunc int* CreateSummedAreaTable(int* grid);
+
+		/// <summary>
+		/// Casts the given int* into a SummedAreaTable* and deletes it
+		/// </summary>
+		dllFunc void DeleteSummedAreaTable(int* summedAreaTable);
+
+		/// <summary>
+		/// Casts the given int* into a SummedAreaTable* and returns the sum of all values in the given rectangle.
+		/// The rectangle is clipped to the bounds of the grid.
+		/// </summary>
+		dllFunc long long GetRegionSum(int* summedAreaTable, int x, int y, int width, int height);
+
+		/// <summary>
+		/// Casts the given int* into a SummedAreaTable* and returns the mean of all values in the given rectangle.
+		/// The rectangle is clipped to the bounds of the grid, an empty rectangle has a mean of 0.
+		/// </summary>
+		dllFunc float GetRegionMean(int* summedAreaTable, int x, int y, int width, int height);
+
+		/// <summary>
+		/// Casts the given int* into a SummedAreaTable* and returns the number of coordinates in the given rectangle that are not set to the DefaultValue.
+		/// The rectangle is clipped to the bounds of the grid.
+		/// </summary>
+		dllFunc int GetRegionSetCount(int* summedAreaTable, int x, int y, int width, int height);
+
+		/// <summary>
+		/// Casts the given int* into a SummedAreaTable* and returns the number of coordinates in the given rectangle after clipping it to the bounds of the grid.
+		/// </summary>
+		dllFunc int GetRegionCount(int* summedAreaTable, int x, int y, int width, int height);
+
+		/// <summary>
+		/// Casts the given int* into a SummedAreaTable* and writes the sum of each given rectangle into sums. The rects int* is structured as follows:
+		/// [0] = Num of rectangles
+		/// [1] = X coordinate of 1. rectangle
+		/// [2] = Y coordinate of 1. rectangle
+		/// [3] = Width of 1. rectangle
+		/// [4] = Height of 1. rectangle
+		/// Repeat [1]-[4] for each rectangle
+		/// sums has to hold at least rects[0] values
+		/// </summary>
+		dllFunc void GetRegionSums(int* summedAreaTable, int* rects, long long* sums);
+
+		/// <summary>
+		/// Casts the given int* into a SummedAreaTable* and writes the mean of each given rectangle into means.
+		/// The rects int* is structured like the one of GetRegionSums, means has to hold at least rects[0] values
+		/// </summary>
+		dllFunc void GetRegionMeans(int* summedAreaTable, int* rects, float* means);
+
+		/// <summary>
+		/// Casts the given int* into a SummedAreaTable* and writes the number of coordinates not set to the DefaultValue in each given rectangle into setCounts.
+		/// The rects int* is structured like the one of GetRegionSums, setCounts has to hold at least rects[0] values
+		/// </summary>
+		dllFunc void GetRegionSetCounts(int* summedAreaTable, int* rects, int* setCounts);
+
+		/// <summary>
+		/// Creates a pointer to a cooperative planner searching on the given grid and casts it into an int*.
+		/// Agents planned by it reserve the coordinates they occupy for the next window timesteps, agents planned later avoid them.
+		/// </summary>
+		/// <param name="grid">Grid providing the movement cost if useCost is set</param>
+		/// <param name="window">Number of timesteps reserved per plan, agents should be planned again before they reach its end. No paths are planned if it is negative</param>
+		/// <param name="usableValues">Values agents may move on, structured as [0] = Num of values, [1..n] = values. Pass null to allow all values</param>
+		/// <param name="valueGrid">Grid the usableValues are checked on, ignored if usableValues is null. Has to have the same size as grid, otherwise no paths are planned</param>
+		dllFunc int* CreateCooperativePlanner(int* grid, int window, bool useCost, int* usableValues, int* valueGrid);
+
+		/// <summary>
+		/// Casts the given int* into a CooperativePlanner* and deletes it
+		/// </summary>
+		dllFunc void DeleteCooperativePlanner(int* planner);
+
+		/// <summary>
+		/// Casts the given int* into a CooperativePlanner* and plans paths for all given agents, earlier agents have priority over later ones.
+		/// Previous reservations of the given agents are released first. The agents int* is structured as follows:
+		/// [0] = Num of agents
+		/// [1] = Id, [2] = Start X, [3] = Start Y, [4] = End X, [5] = End Y of the 1. agent
+		/// Repeat [1]-[5] for each agent
+		/// The returned int* is structured as follows:
+		/// [0] = Num of agents
+		/// [1] = Id of the 1. agent
+		/// [2] = Num of coordinates on its path
+		/// [3] = X coordinate, [4] = Y coordinate of the coordinate on the current timestep, followed by one coordinate per timestep
+		/// Repeat from [1] for each agent
+		/// Unlike AStarSearch the paths start at the agents start coordinate, waiting shows up as a repeated coordinate
+		/// </summary>
+		dllFunc int* PlanCooperativePaths(int* planner, int* agents);
+
+		/// <summary>
+		/// Casts the given int* into a CooperativePlanner* and moves it the given number of timesteps forward.
+		/// Reservations of passed timesteps are released.
+		/// </summary>
+		dllFunc void AdvanceCooperativePlanner(int* planner, int timesteps);
+
+		/// <summary>
+		/// Casts the given int* into a CooperativePlanner* and releases all reservations of the given agent
+		/// </summary>
+		dllFunc void ReleaseCooperativeAgent(int* planner, int agentId);
+
 		/// <summary>
 		/// Delete the int* with delete[]
 		/// </summary>
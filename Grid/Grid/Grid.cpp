@@ -1,5 +1,97 @@
 #include "pch.h"
 #include "Grid.h"
+#include "ClearanceMap.h"
+#include "GridKernels.h"
+#include "GridObserver.h"
+#include "ValueSet.h"
+#include <algorithm>
+#include <cstdlib>
+#include <float.h>
+#include <queue>
+#include <thread>
+
+namespace
+{
+	// Regions smaller than this are scanned on the calling thread even if parallel is requested
+	const long long c_MinParallelCells = 1 << 16;
+
+	struct InBoundsWalkable
+	{
+		const int* Values;
+		int OutOfBoundsValue;
+
+		bool operator()(int idx) const
+		{
+			return Values[idx] != OutOfBoundsValue;
+		}
+	};
+
+	struct UsableValueWalkable
+	{
+		const int* Values;
+		const ValueSet* UsableValues;
+
+		bool operator()(int idx) const
+		{
+			return UsableValues->Contains(Values[idx]);
+		}
+	};
+
+	struct ClearanceWalkable
+	{
+		const ClearanceMap* Clearance;
+		int AgentSize;
+
+		bool operator()(int idx) const
+		{
+			return Clearance->GetClearance(idx) >= AgentSize;
+		}
+	};
+
+	// Costs and parents of a search, indexed like the padded grid. Entries are only valid if their
+	// generation matches the current search, so starting a search never has to clear the buffers.
+	struct SearchBuffers
+	{
+		std::vector<unsigned> Generations;
+		std::vector<float> Costs;
+		std::vector<int> Parents;
+		unsigned Generation = 0;
+
+		unsigned Begin(size_t size)
+		{
+			if (Generations.size() < size)
+			{
+				Generations.resize(size, 0);
+				Costs.resize(size);
+				Parents.resize(size);
+			}
+
+			Generation++;
+			if (Generation == 0)
+			{
+				std::fill(Generations.begin(), Generations.end(), 0);
+				Generation = 1;
+			}
+			return Generation;
+		}
+	};
+
+	// Every thread reuses its own buffers for all searches, sized for the largest grid it searched.
+	// Concurrent searches on one grid stay independent and grids themselves hold no search state.
+	thread_local SearchBuffers t_SearchBuffers;
+
+	struct OpenEntry
+	{
+		float Priority;
+		float Cost;
+		int Idx;
+
+		bool operator>(const OpenEntry& other) const
+		{
+			return Priority > other.Priority;
+		}
+	};
+}
 
 Grid::Grid(int width, int height, int defaultValue, int outOfBoundsValue)
 	:Width(width)
@@ -7,9 +99,10 @@ Grid::Grid(int width, int height, int defaultValue, int outOfBoundsValue)
 	,DefaultValue(defaultValue)
 	,OutOfBoundsValue(outOfBoundsValue)
 {
-	for (int i = 0; i < width*height; i++)
+	m_Grid.resize((width + 2) * (height + 2), outOfBoundsValue);
+	for (int y = 0; y < height; y++)
 	{
-		m_Grid.push_back(defaultValue);
+		std::fill_n(m_Grid.begin() + CoordinateToGridIdx({ 0, y }), width, defaultValue);
 	}
 }
 
@@ -19,338 +112,554 @@ Grid::Grid(const Grid &g)
 	,DefaultValue(g.DefaultValue)
 	,OutOfBoundsValue(g.OutOfBoundsValue)
 {
-	for (int i = 0; i < g.Width* g.Height; i++)
+	m_Grid.resize((g.Width + 2) * (g.Height + 2), g.OutOfBoundsValue);
+	for (int y = 0; y < g.Height; y++)
+	{
+		std::fill_n(m_Grid.begin() + CoordinateToGridIdx({ 0, y }), g.Width, g.DefaultValue);
+	}
+}
+
+Grid::~Grid()
+{
+	for (auto observer : m_Observers)
 	{
-		m_Grid.push_back(g.DefaultValue);
+		observer->DetachGrid();
 	}
 }
 
 int Grid::GetGridContent(Coordinate cooridnate)
 {
+	if (!IsInBounds(cooridnate)) return OutOfBoundsValue;
 	int pos = CoordinateToGridIdx(cooridnate);
 	return m_Grid[pos];
 }
 
 void Grid::SetGridContent(Coordinate cooridnate, int value)
 {
+	if (!IsInBounds(cooridnate)) return;
 	int pos = CoordinateToGridIdx(cooridnate);
+	if (m_Grid[pos] == value) return;
+	m_Journal.Record(cooridnate, m_Grid[pos], value);
 	m_Grid[pos] = value;
+
+	for (auto observer : m_Observers)
+	{
+		observer->OnGridContentChanged(cooridnate);
+	}
 }
 
 bool Grid::IsPositionSet(Coordinate cooridnate)
 {
+	if (!IsInBounds(cooridnate)) return false;
 	int pos = CoordinateToGridIdx(cooridnate);
 	return m_Grid[pos] != DefaultValue;
 }
 
+bool Grid::IsInBounds(Coordinate coordinate)
+{
+	return coordinate.X >= 0 && coordinate.X < Width && coordinate.Y >= 0 && coordinate.Y < Height;
+}
+
 Coordinate Grid::GetRandomCooridanteOfValue(int value)
 {
-	std::vector<Coordinate> coordinatesOfType;
-	for (int i = 0; i < Width * Height; i++)
+	int count = CountValue(value);
+	if (count == 0) return { OutOfBoundsValue, OutOfBoundsValue };
+
+	int target = (int)((((unsigned)std::rand() << 15) ^ (unsigned)std::rand()) % (unsigned)count);
+	for (int y = 0; y < Height; y++)
 	{
-		if (m_Grid[i] == value)
+		const int* row = &m_Grid[CoordinateToGridIdx({ 0, y })];
+		int rowCount = GridKernels::CountValue(row, Width, value);
+		if (target >= rowCount)
 		{
-			Coordinate coordinate = GridIdxToCoordinate(i);
-			coordinatesOfType.push_back(coordinate);
+			target -= rowCount;
+			continue;
 		}
+
+		std::vector<int> xs;
+		GridKernels::FindValue(row, Width, value, xs);
+		return { xs[target], y };
 	}
+	return { OutOfBoundsValue, OutOfBoundsValue };
+}
 
-	int rand = (std::rand() % (coordinatesOfType.size() + 1));
-	return coordinatesOfType[rand];
+int Grid::CountValue(int value, bool parallel)
+{
+	return CountValue(value, { 0, 0, Width, Height }, parallel);
 }
 
-int Grid::GetAdjacentValidCoordinatesCount(Coordinate coordinate)
+int Grid::CountValue(int value, Rect region, bool parallel)
 {
-	int retval = 0;
-	if (coordinate.X > 0)
-	{
-		retval++;
-	}
-	if (coordinate.X < Width - 1)
-	{
-		retval++;
-	}
-	if (coordinate.Y > 0)
+	if (!ClipRegion(region)) return 0;
+
+	std::vector<int> rowCounts(region.Height, 0);
+	ForEachRow(region, parallel, [&](int y)
 	{
-		retval++;
-	}
-	if (coordinate.Y < Height - 1)
+		const int* row = &m_Grid[CoordinateToGridIdx({ region.X, y })];
+		rowCounts[y - region.Y] = GridKernels::CountValue(row, region.Width, value);
+	});
+
+	int count = 0;
+	for (auto rowCount : rowCounts)
 	{
-		retval++;
+		count += rowCount;
 	}
-	return retval;
+	return count;
 }
 
-std::vector<Coordinate> Grid::GetAdjacentVaildCoordinates(Coordinate coordinate)
+std::vector<Coordinate> Grid::FindValue(int value, bool parallel)
+{
+	return FindValue(value, { 0, 0, Width, Height }, parallel);
+}
+
+std::vector<Coordinate> Grid::FindValue(int value, Rect region, bool parallel)
 {
 	std::vector<Coordinate> retVal;
-	if (coordinate.X > 0)
-	{
-		retVal.push_back({ coordinate.X - 1, coordinate.Y });
-	}
-	if (coordinate.X < Width - 1)
-	{
-		retVal.push_back({ coordinate.X + 1, coordinate.Y });
-	}
-	if (coordinate.Y > 0)
+	if (!ClipRegion(region)) return retVal;
+
+	std::vector<std::vector<int>> rowMatches(region.Height);
+	ForEachRow(region, parallel, [&](int y)
 	{
-		retVal.push_back({ coordinate.X, coordinate.Y - 1 });
-	}
-	if (coordinate.Y < Height - 1)
+		const int* row = &m_Grid[CoordinateToGridIdx({ region.X, y })];
+		GridKernels::FindValue(row, region.Width, value, rowMatches[y - region.Y]);
+	});
+
+	for (int i = 0; i < region.Height; i++)
 	{
-		retVal.push_back({ coordinate.X, coordinate.Y + 1 });
+		for (auto x : rowMatches[i])
+		{
+			retVal.push_back({ region.X + x, region.Y + i });
+		}
 	}
 	return retVal;
 }
 
-std::vector<Coordinate> Grid::GetAdjacentValidCoordinatesWithValues(Coordinate coordinate, std::vector<int> value)
+int Grid::ReplaceValue(int from, int to, bool parallel)
 {
-	std::vector<Coordinate> retVal;
-	if (coordinate.X > 0)
+	return ReplaceValue(from, to, { 0, 0, Width, Height }, parallel);
+}
+
+// Rows are rewritten by the kernels, possibly in parallel. If the journal can still hold every
+// change they are recorded per coordinate on the calling thread, otherwise only the rows that changed
+// are recorded as one dirty region and the kernels just count. Observers are notified once for the
+// bounds of all changes.
+int Grid::ReplaceValue(int from, int to, Rect region, bool parallel)
+{
+	if (from == to || !ClipRegion(region)) return 0;
+
+	int expected = CountValue(from, region, parallel);
+	if (expected == 0) return 0;
+
+	Rect changed;
+	if (expected <= m_Journal.GetRemainingCapacity())
 	{
-		Coordinate neighbor = { coordinate.X - 1, coordinate.Y };
-		int gridIdx = CoordinateToGridIdx(neighbor);
-		if (std::find(value.begin(), value.end(), m_Grid[gridIdx]) != value.end())
+		std::vector<std::vector<int>> rowChanges(region.Height);
+		ForEachRow(region, parallel, [&](int y)
 		{
-			retVal.push_back(neighbor);
-		}
-	}
-	if (coordinate.X < Width - 1)
-	{
-		Coordinate neighbor = { coordinate.X + 1, coordinate.Y };
-		int gridIdx = CoordinateToGridIdx(neighbor);
-		if (std::find(value.begin(), value.end(), m_Grid[gridIdx]) != value.end())
+			int* row = &m_Grid[CoordinateToGridIdx({ region.X, y })];
+			GridKernels::ReplaceValue(row, region.Width, from, to, rowChanges[y - region.Y]);
+		});
+
+		int minX = INT_MAX;
+		int minY = INT_MAX;
+		int maxX = INT_MIN;
+		int maxY = INT_MIN;
+		for (int i = 0; i < region.Height; i++)
 		{
-			retVal.push_back(neighbor);
+			auto& changes = rowChanges[i];
+			if (changes.empty()) continue;
+
+			int y = region.Y + i;
+			for (auto x : changes)
+			{
+				m_Journal.Record({ region.X + x, y }, from, to);
+			}
+			minX = std::min(minX, region.X + changes.front());
+			maxX = std::max(maxX, region.X + changes.back());
+			minY = std::min(minY, y);
+			maxY = y;
 		}
+		changed = { minX, minY, maxX - minX + 1, maxY - minY + 1 };
 	}
-	if (coordinate.Y > 0)
+	else
 	{
-		Coordinate neighbor = { coordinate.X, coordinate.Y - 1};
-		int gridIdx = CoordinateToGridIdx(neighbor);
-		if (std::find(value.begin(), value.end(), m_Grid[gridIdx]) != value.end())
+		std::vector<int> rowCounts(region.Height, 0);
+		ForEachRow(region, parallel, [&](int y)
+		{
+			int* row = &m_Grid[CoordinateToGridIdx({ region.X, y })];
+			rowCounts[y - region.Y] = GridKernels::ReplaceValue(row, region.Width, from, to);
+		});
+
+		int minY = INT_MAX;
+		int maxY = INT_MIN;
+		for (int i = 0; i < region.Height; i++)
 		{
-			retVal.push_back(neighbor);
+			if (rowCounts[i] == 0) continue;
+
+			minY = std::min(minY, region.Y + i);
+			maxY = region.Y + i;
 		}
+		changed = { region.X, minY, region.Width, maxY - minY + 1 };
+		m_Journal.RecordRegion(changed);
 	}
-	if (coordinate.Y < Height - 1)
+
+	for (auto observer : m_Observers)
 	{
-		Coordinate neighbor = { coordinate.X, coordinate.Y + 1};
-		int gridIdx = CoordinateToGridIdx(neighbor);
-		if (std::find(value.begin(), value.end(), m_Grid[gridIdx]) != value.end())
-		{
-			retVal.push_back(neighbor);
-		}
+		observer->OnGridRegionChanged(changed);
 	}
-	return retVal;
+	return expected;
 }
 
-std::vector<int> Grid::GetAdjacentValidValues(Coordinate coordinate)
+int Grid::GetAdjacentValidCoordinatesCount(Coordinate coordinate)
 {
-	std::vector<int> retVal;
-	if (coordinate.X > 0)
-	{
-		int gridIdx = CoordinateToGridIdx({ coordinate.X + 1, coordinate.Y });
-		retVal.push_back(m_Grid[gridIdx]);
-	}
-	if (coordinate.X < Width - 1)
+	int retval = 0;
+	InBoundsWalkable inBounds{ m_Grid.data(), OutOfBoundsValue };
+	ForEachNeighbor<FourConnected>(CoordinateToGridIdx(coordinate), Width + 2, inBounds, [&](int, int)
 	{
-		int gridIdx = CoordinateToGridIdx({ coordinate.X - 1, coordinate.Y });
-		retVal.push_back(m_Grid[gridIdx]);
-	}
-	if (coordinate.Y > 0)
+		retval++;
+	});
+	return retval;
+}
+
+std::vector<Coordinate> Grid::GetAdjacentVaildCoordinates(Coordinate coordinate)
+{
+	std::vector<Coordinate> retVal;
+	InBoundsWalkable inBounds{ m_Grid.data(), OutOfBoundsValue };
+	ForEachNeighbor<FourConnected>(CoordinateToGridIdx(coordinate), Width + 2, inBounds, [&](int neighbor, int)
 	{
-		int gridIdx = CoordinateToGridIdx({ coordinate.X, coordinate.Y - 1});
-		retVal.push_back(m_Grid[gridIdx]);
-	}
-	if (coordinate.Y < Height - 1)
+		retVal.push_back(GridIdxToCoordinate(neighbor));
+	});
+	return retVal;
+}
+
+std::vector<Coordinate> Grid::GetAdjacentValidCoordinatesWithValues(Coordinate coordinate, const std::vector<int>& value)
+{
+	std::vector<Coordinate> retVal;
+	ValueSet usableValues(value, OutOfBoundsValue);
+	UsableValueWalkable usable{ m_Grid.data(), &usableValues };
+	ForEachNeighbor<FourConnected>(CoordinateToGridIdx(coordinate), Width + 2, usable, [&](int neighbor, int)
 	{
-		int gridIdx = CoordinateToGridIdx({ coordinate.X, coordinate.Y + 1});
-		retVal.push_back(m_Grid[gridIdx]);
-	}
+		retVal.push_back(GridIdxToCoordinate(neighbor));
+	});
 	return retVal;
 }
 
-std::vector<int> Grid::GetAdjacentValues(Coordinate coordinate)
+std::vector<int> Grid::GetAdjacentValidValues(Coordinate coordinate)
 {
 	std::vector<int> retVal;
-	for (int i = 0; i < 4; i++)
-	{
-		retVal.push_back(OutOfBoundsValue);
-	}
-	if (coordinate.X > 0)
-	{
-		int gridIdx = CoordinateToGridIdx({ coordinate.X - 1, coordinate.Y });
-		retVal[0] = m_Grid[gridIdx];
-	}
-	if (coordinate.X < Width - 1)
+	InBoundsWalkable inBounds{ m_Grid.data(), OutOfBoundsValue };
+	ForEachNeighbor<FourConnected>(CoordinateToGridIdx(coordinate), Width + 2, inBounds, [&](int neighbor, int)
 	{
-		int gridIdx = CoordinateToGridIdx({ coordinate.X + 1, coordinate.Y });
-		retVal[2] = m_Grid[gridIdx];
-	}
-	if (coordinate.Y > 0)
-	{
-		int gridIdx = CoordinateToGridIdx({ coordinate.X, coordinate.Y - 1 });
-		retVal[3] = m_Grid[gridIdx];
-	}
-	if (coordinate.Y < Height - 1)
+		retVal.push_back(m_Grid[neighbor]);
+	});
+	return retVal;
+}
+
+std::vector<int> Grid::GetAdjacentValues(Coordinate coordinate)
+{
+	std::vector<int> retVal(4);
+	GetAdjacentValues(coordinate, retVal.data());
+	return retVal;
+}
+
+void Grid::GetAdjacentValues(Coordinate coordinate, int* values)
+{
+	int idx = CoordinateToGridIdx(coordinate);
+	int stride = Width + 2;
+	for (int direction = 0; direction < 4; direction++)
 	{
-		int gridIdx = CoordinateToGridIdx({ coordinate.X, coordinate.Y + 1 });
-		retVal[1] = m_Grid[gridIdx];
+		values[direction] = m_Grid[idx + NeighborOffsets::Y[direction] * stride + NeighborOffsets::X[direction]];
 	}
-	return retVal;
 }
 
-std::vector<Coordinate> Grid::AStarSearch(Coordinate start, Coordinate end, bool useCost)
+std::vector<Coordinate> Grid::AStarSearch(Coordinate start, Coordinate end, bool useCost, Connectivity connectivity)
+{
+	InBoundsWalkable inBounds{ m_Grid.data(), OutOfBoundsValue };
+	return DispatchAStarSearch(start, end, useCost, inBounds, connectivity);
+}
+
+std::vector<Coordinate> Grid::AStarSearch(Coordinate start, Coordinate end, bool useCost, const AStarValueInfo& typeInfo, Connectivity connectivity)
+{
+	if (!HasSameSize(typeInfo.ValueGrid)) return std::vector<Coordinate>();
+
+	ValueSet usableValues(typeInfo.UseableValues, typeInfo.ValueGrid->OutOfBoundsValue);
+	UsableValueWalkable usable{ typeInfo.ValueGrid->m_Grid.data(), &usableValues };
+	return DispatchAStarSearch(start, end, useCost, usable, connectivity);
+}
+
+std::vector<Coordinate> Grid::AStarSearch(Coordinate start, Coordinate end, bool useCost, ClearanceMap* clearanceMap, int agentSize, Connectivity connectivity)
 {
 	std::vector<Coordinate> path;
+	if (clearanceMap == nullptr || agentSize < 1 || !HasSameSize(clearanceMap->ValueGrid)) return path;
 
-	std::vector<Coordinate> coordsToCheck;
-	std::map<Coordinate, int> costMap;
-	std::map<Coordinate, float> priorityMap;
-	std::map<Coordinate, Coordinate> parentsMap;
+	ClearanceWalkable fits{ clearanceMap, agentSize };
+	return DispatchAStarSearch(start, end, useCost, fits, connectivity);
+}
 
-	coordsToCheck.push_back(start);
-	costMap[start] = 0;
-	priorityMap[start] = 0;
-	parentsMap[start] = { OutOfBoundsValue,OutOfBoundsValue };
+// Keeps the first and last coordinate and every coordinate where the direction of the path changes.
+std::vector<Coordinate> Grid::SimplifyPath(const std::vector<Coordinate>& path)
+{
+	if (path.size() < 3) return path;
 
-	while (coordsToCheck.size() > 0)
+	std::vector<Coordinate> retVal;
+	retVal.push_back(path[0]);
+	for (size_t i = 1; i < path.size() - 1; i++)
 	{
-		auto current = GetClosestCoordinate(coordsToCheck, priorityMap);
-		auto it = coordsToCheck.begin();
-		for (auto& coord : coordsToCheck)
+		int inX = path[i].X - path[i - 1].X;
+		int inY = path[i].Y - path[i - 1].Y;
+		int outX = path[i + 1].X - path[i].X;
+		int outY = path[i + 1].Y - path[i].Y;
+		if (inX != outX || inY != outY)
 		{
-			if (coord == current)
-			{
-				break;
-			}
-			it++;
+			retVal.push_back(path[i]);
 		}
-		coordsToCheck.erase(it);
-		
-		if (current == end)
+	}
+	retVal.push_back(path.back());
+	return retVal;
+}
+
+// Greedily skips waypoints as long as the straight line from the last kept waypoint only
+// crosses usable values of this grid.
+std::vector<Coordinate> Grid::StringPullPath(const std::vector<Coordinate>& path, const std::vector<int>& usableValues)
+{
+	if (path.size() < 3) return path;
+
+	ValueSet usable(usableValues, OutOfBoundsValue);
+	std::vector<Coordinate> retVal;
+	retVal.push_back(path[0]);
+	for (size_t i = 2; i < path.size(); i++)
+	{
+		if (!HasLineOfSight(retVal.back(), path[i], usable))
 		{
-			path = GeneratePath(parentsMap, current);
-			return path;
+			retVal.push_back(path[i - 1]);
 		}
+	}
+	retVal.push_back(path.back());
+	return retVal;
+}
 
-		auto neighbors = GetAdjacentVaildCoordinates(current);
-		for (auto neighbor : neighbors)
-		{
-			auto newCost = useCost
-				? costMap[current] + m_Grid[CoordinateToGridIdx(neighbor)]
-				: 0;
+bool Grid::HasLineOfSight(Coordinate from, Coordinate to, const std::vector<int>& usableValues)
+{
+	ValueSet usable(usableValues, OutOfBoundsValue);
+	return HasLineOfSight(from, to, usable);
+}
 
-			if (costMap.count(neighbor) && !(newCost < costMap[neighbor])) continue;
-			costMap[neighbor] = newCost;
+int Grid::CommitChanges()
+{
+	return m_Journal.Commit();
+}
 
-			auto priority = newCost + ManhattanDistance(neighbor, end);
-			coordsToCheck.push_back(neighbor);
-			priorityMap[neighbor] = priority;
+int Grid::GetVersion()
+{
+	return m_Journal.GetVersion();
+}
 
-			parentsMap[neighbor] = current;
-		}
-	}
-	return path;
+JournalChanges Grid::GetChangesSince(int version)
+{
+	return m_Journal.GetChangesSince(version);
 }
 
-std::vector<Coordinate> Grid::AStarSearch(Coordinate start, Coordinate end, bool useCost, AStarValueInfo typeInfo)
+void Grid::AddObserver(GridObserver* observer)
 {
-	std::vector<Coordinate> path;
+	m_Observers.push_back(observer);
+}
 
-	std::vector<Coordinate> coordsToCheck;
-	std::map<Coordinate, int> costMap;
-	std::map<Coordinate, float> priorityMap;
-	std::map<Coordinate, Coordinate> parentsMap;
+void Grid::RemoveObserver(GridObserver* observer)
+{
+	auto it = std::find(m_Observers.begin(), m_Observers.end(), observer);
+	if (it != m_Observers.end())
+	{
+		m_Observers.erase(it);
+	}
+}
 
-	coordsToCheck.push_back(start);
-	costMap[start] = 0;
-	priorityMap[start] = 0;
-	parentsMap[start] = { OutOfBoundsValue,OutOfBoundsValue };
+// Value grids and clearance maps are read with this grid's indices, so they need the same size
+bool Grid::HasSameSize(Grid* other)
+{
+	return other != nullptr && other->Width == Width && other->Height == Height;
+}
 
-	if (std::find(typeInfo.UseableValues.begin(), 
-				  typeInfo.UseableValues.end(), 
-		          typeInfo.ValueGrid->m_Grid[CoordinateToGridIdx(start)]) 
-		== typeInfo.UseableValues.end()) return path;
+bool Grid::ClipRegion(Rect& region)
+{
+	int right = std::min(region.X + region.Width, Width);
+	int bottom = std::min(region.Y + region.Height, Height);
+	region.X = std::max(region.X, 0);
+	region.Y = std::max(region.Y, 0);
+	region.Width = right - region.X;
+	region.Height = bottom - region.Y;
+	return region.Width > 0 && region.Height > 0;
+}
 
-	while (coordsToCheck.size() > 0)
+template<typename TFunc>
+void Grid::ForEachRow(Rect region, bool parallel, TFunc func)
+{
+	int threadCount = parallel ? (int)std::thread::hardware_concurrency() : 1;
+	threadCount = std::min(threadCount, region.Height);
+	if ((long long)region.Width * region.Height < c_MinParallelCells || threadCount <= 1)
 	{
-		auto current = GetClosestCoordinate(coordsToCheck, priorityMap);
-		auto it = coordsToCheck.begin();
-		for (auto& coord : coordsToCheck)
+		for (int y = region.Y; y < region.Y + region.Height; y++)
 		{
-			if (coord == current)
+			func(y);
+		}
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	int rowsPerThread = (region.Height + threadCount - 1) / threadCount;
+	for (int begin = region.Y; begin < region.Y + region.Height; begin += rowsPerThread)
+	{
+		int end = std::min(begin + rowsPerThread, region.Y + region.Height);
+		threads.emplace_back([begin, end, &func]()
+		{
+			for (int y = begin; y < end; y++)
 			{
-				break;
+				func(y);
 			}
-			it++;
-		}
-		coordsToCheck.erase(it);
+		});
+	}
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+int Grid::CoordinateToGridIdx(Coordinate cell)
+{
+	return (cell.Y + 1) * (Width + 2) + cell.X + 1;
+}
 
-		if (current == end)
+Coordinate Grid::GridIdxToCoordinate(int pos)
+{
+	return { pos % (Width + 2) - 1, pos / (Width + 2) - 1 };
+}
+
+template<typename TWalkable>
+std::vector<Coordinate> Grid::DispatchAStarSearch(Coordinate start, Coordinate end, bool useCost, const TWalkable& walkable, Connectivity connectivity)
+{
+	switch (connectivity)
+	{
+	case Connectivity::Eight:
+		return RunAStarSearch<EightConnected>(start, end, useCost, walkable);
+	case Connectivity::EightNoCornerCutting:
+		return RunAStarSearch<EightConnectedNoCornerCutting>(start, end, useCost, walkable);
+	default:
+		return RunAStarSearch<FourConnected>(start, end, useCost, walkable);
+	}
+}
+
+// Without useCost every reached coordinate keeps a cost of 0 and is never reopened,
+// which makes the search a greedy best first search on the heuristic alone.
+template<typename TPolicy, typename TWalkable>
+std::vector<Coordinate> Grid::RunAStarSearch(Coordinate start, Coordinate end, bool useCost, const TWalkable& walkable)
+{
+	std::vector<Coordinate> path;
+	if (!IsInBounds(start) || !IsInBounds(end)) return path;
+
+	int startIdx = CoordinateToGridIdx(start);
+	int endIdx = CoordinateToGridIdx(end);
+	if (!walkable(startIdx)) return path;
+
+	int stride = Width + 2;
+	SearchBuffers& search = t_SearchBuffers;
+	unsigned generation = search.Begin(m_Grid.size());
+	auto costOf = [&](int idx)
+	{
+		return search.Generations[idx] == generation ? search.Costs[idx] : FLT_MAX;
+	};
+	std::vector<OpenEntry> openStorage;
+	openStorage.reserve(Width + Height);
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> coordsToCheck(std::greater<OpenEntry>(), std::move(openStorage));
+
+	search.Generations[startIdx] = generation;
+	search.Costs[startIdx] = 0;
+	search.Parents[startIdx] = -1;
+	coordsToCheck.push({ 0, 0, startIdx });
+
+	while (!coordsToCheck.empty())
+	{
+		auto current = coordsToCheck.top();
+		coordsToCheck.pop();
+		if (current.Cost > search.Costs[current.Idx]) continue;
+
+		if (current.Idx == endIdx)
 		{
-			path = GeneratePath(parentsMap, current);
-			return path;
+			return GeneratePath(search.Parents, endIdx);
 		}
 
-		auto neighbors = typeInfo.ValueGrid->GetAdjacentValidCoordinatesWithValues(current, typeInfo.UseableValues);
-		for (auto neighbor : neighbors)
+		int currentX = current.Idx % stride;
+		int currentY = current.Idx / stride;
+		ForEachNeighbor<TPolicy>(current.Idx, stride, walkable, [&](int neighbor, int direction)
 		{
-			auto newCost = useCost
-				? costMap[current] + m_Grid[CoordinateToGridIdx(neighbor)]
+			float step = direction < 4 ? 1.0f : NeighborOffsets::DiagonalStep;
+			float newCost = useCost
+				? current.Cost + m_Grid[neighbor] * step
 				: 0;
 
-			if (costMap.count(neighbor) && !(newCost < costMap[neighbor])) continue;
-			costMap[neighbor] = newCost;
-
-			auto priority = newCost + ManhattanDistance(neighbor, end);
-			coordsToCheck.push_back(neighbor);
-			priorityMap[neighbor] = priority;
+			if (!(newCost < costOf(neighbor))) return;
+			search.Generations[neighbor] = generation;
+			search.Costs[neighbor] = newCost;
+			search.Parents[neighbor] = current.Idx;
 
-			parentsMap[neighbor] = current;
-		}
+			int dx = abs(end.X + 1 - (currentX + NeighborOffsets::X[direction]));
+			int dy = abs(end.Y + 1 - (currentY + NeighborOffsets::Y[direction]));
+			coordsToCheck.push({ newCost + TPolicy::Heuristic(dx, dy), newCost, neighbor });
+		});
 	}
 	return path;
 }
 
-int Grid::CoordinateToGridIdx(Coordinate cell)
+// Walks every coordinate the segment between both coordinate centers touches. Where the segment
+// passes exactly through a corner both coordinates next to that corner have to be usable.
+bool Grid::HasLineOfSight(Coordinate from, Coordinate to, const ValueSet& usableValues)
 {
-	return cell.Y * Width + cell.X;
-}
+	if (!IsInBounds(from) || !IsInBounds(to)) return false;
 
-Coordinate Grid::GridIdxToCoordinate(int pos)
-{
-	return { pos / Width,pos % Width };
-}
+	int stride = Width + 2;
+	int nx = abs(to.X - from.X);
+	int ny = abs(to.Y - from.Y);
+	int stepX = to.X > from.X ? 1 : -1;
+	int stepY = to.Y > from.Y ? stride : -stride;
 
-Coordinate Grid::GetClosestCoordinate(std::vector<Coordinate> coordsToChek, std::map<Coordinate, float> distanceMap)
-{
-	Coordinate candidate = coordsToChek[0];
+	int idx = CoordinateToGridIdx(from);
+	if (!usableValues.Contains(m_Grid[idx])) return false;
 
-	for (auto &coord : coordsToChek)
+	for (int ix = 0, iy = 0; ix < nx || iy < ny;)
 	{
-		if (distanceMap[coord] < distanceMap[candidate])
+		long long decision = (1 + 2LL * ix) * ny - (1 + 2LL * iy) * nx;
+		if (decision == 0)
+		{
+			if (!usableValues.Contains(m_Grid[idx + stepX]) || !usableValues.Contains(m_Grid[idx + stepY])) return false;
+			idx += stepX + stepY;
+			ix++;
+			iy++;
+		}
+		else if (decision < 0)
+		{
+			idx += stepX;
+			ix++;
+		}
+		else
 		{
-			candidate = coord;
+			idx += stepY;
+			iy++;
 		}
+		if (!usableValues.Contains(m_Grid[idx])) return false;
 	}
-	return candidate;
+	return true;
+}
+
+// Frees the search buffers of the calling thread, the next search on it allocates them again
+void Grid::ReleaseSearchBuffers()
+{
+	t_SearchBuffers = SearchBuffers();
 }
 
-std::vector<Coordinate> Grid::GeneratePath(std::map<Coordinate, Coordinate> parentsMap, Coordinate end)
+std::vector<Coordinate> Grid::GeneratePath(const std::vector<int>& parents, int end)
 {
 	std::vector<Coordinate> path;
-	Coordinate parent = end;
-	while (parent != Coordinate{OutOfBoundsValue, OutOfBoundsValue} && parentsMap.count(parent))
+	for (int idx = end; idx != -1; idx = parents[idx])
 	{
-		path.push_back(parent);
-		parent = parentsMap[parent];
+		path.push_back(GridIdxToCoordinate(idx));
 	}
 	return path;
 }
-
-float Grid::ManhattanDistance(Coordinate current, Coordinate end)
-{
-	return fabs(end.X - current.X) + fabs(end.Y - current.Y);
-}
@@ -1,29 +1,57 @@
 #pragma once
+#include "ChangeJournal.h"
+#include "NeighborPolicy.h"
 #include "Structs.h"
 #include <limits.h>
-#include <map>
 #include <vector>
 
+class ClearanceMap;
+class GridObserver;
+class ValueSet;
+
 class Grid
 {
 public:
 	Grid(int width, int height, int defaultValue = -1, int outOfBoundsValue = INT_MIN);
 	Grid(const Grid &g);
+	~Grid();
 
 	int GetGridContent(Coordinate cooridnate);
 	void SetGridContent(Coordinate cooridnate, int value);
 
 	bool IsPositionSet(Coordinate cooridnate);
+	bool IsInBounds(Coordinate coordinate);
 	Coordinate GetRandomCooridanteOfValue(int value);
 
+	int CountValue(int value, bool parallel = false);
+	int CountValue(int value, Rect region, bool parallel = false);
+	std::vector<Coordinate> FindValue(int value, bool parallel = false);
+	std::vector<Coordinate> FindValue(int value, Rect region, bool parallel = false);
+	int ReplaceValue(int from, int to, bool parallel = false);
+	int ReplaceValue(int from, int to, Rect region, bool parallel = false);
+
 	int GetAdjacentValidCoordinatesCount(Coordinate coordinate);
 	std::vector<Coordinate> GetAdjacentVaildCoordinates(Coordinate coordinate);
-	std::vector<Coordinate> GetAdjacentValidCoordinatesWithValues(Coordinate coordinate, std::vector<int> value);
+	std::vector<Coordinate> GetAdjacentValidCoordinatesWithValues(Coordinate coordinate, const std::vector<int>& value);
 	std::vector<int> GetAdjacentValidValues(Coordinate coordinate);
 	std::vector<int> GetAdjacentValues(Coordinate coordinate);
+	void GetAdjacentValues(Coordinate coordinate, int* values);
+
+	std::vector<Coordinate> AStarSearch(Coordinate start, Coordinate end, bool useCost, Connectivity connectivity = Connectivity::Four);
+	std::vector<Coordinate> AStarSearch(Coordinate start, Coordinate end, bool useCost, const AStarValueInfo& typeInfo, Connectivity connectivity = Connectivity::Four);
+	std::vector<Coordinate> AStarSearch(Coordinate start, Coordinate end, bool useCost, ClearanceMap* clearanceMap, int agentSize, Connectivity connectivity = Connectivity::Four);
+	static void ReleaseSearchBuffers();
+
+	static std::vector<Coordinate> SimplifyPath(const std::vector<Coordinate>& path);
+	std::vector<Coordinate> StringPullPath(const std::vector<Coordinate>& path, const std::vector<int>& usableValues);
+	bool HasLineOfSight(Coordinate from, Coordinate to, const std::vector<int>& usableValues);
+
+	int CommitChanges();
+	int GetVersion();
+	JournalChanges GetChangesSince(int version);
 
-	std::vector<Coordinate> AStarSearch(Coordinate start, Coordinate end, bool useCost);
-	std::vector<Coordinate> AStarSearch(Coordinate start, Coordinate end, bool useCost, AStarValueInfo typeInfo);
+	void AddObserver(GridObserver* observer);
+	void RemoveObserver(GridObserver* observer);
 	
 	int Width;
 	int Height;
@@ -33,11 +61,23 @@ public:
 private:
 	int CoordinateToGridIdx(Coordinate cell);
 	Coordinate GridIdxToCoordinate(int pos);
-	
-	Coordinate GetClosestCoordinate(std::vector<Coordinate> coordsToChek, std::map<Coordinate, float> distanceMap);
-	std::vector<Coordinate> GeneratePath(std::map<Coordinate, Coordinate> parentsMap, Coordinate end);
-	float ManhattanDistance(Coordinate current, Coordinate end);
-	
+
+	bool HasSameSize(Grid* other);
+	bool ClipRegion(Rect& region);
+	template<typename TFunc>
+	void ForEachRow(Rect region, bool parallel, TFunc func);
+
+	template<typename TWalkable>
+	std::vector<Coordinate> DispatchAStarSearch(Coordinate start, Coordinate end, bool useCost, const TWalkable& walkable, Connectivity connectivity);
+	template<typename TPolicy, typename TWalkable>
+	std::vector<Coordinate> RunAStarSearch(Coordinate start, Coordinate end, bool useCost, const TWalkable& walkable);
+	std::vector<Coordinate> GeneratePath(const std::vector<int>& parents, int end);
+	bool HasLineOfSight(Coordinate from, Coordinate to, const ValueSet& usableValues);
+
+	// Row major storage with a border of one OutOfBoundsValue cell on each side,
+	// so neighbor lookups never need bounds checks. The row stride is Width + 2.
 	std::vector<int> m_Grid;
+	ChangeJournal m_Journal;
+	std::vector<GridObserver*> m_Observers;
 };
 
@@ -0,0 +1,304 @@
+#include "pch.h"
+#include "GridKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GRID_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GRID_TARGET_SSE2
+#define GRID_TARGET_AVX2
+#else
+#define GRID_TARGET_SSE2 __attribute__((target("sse2")))
+#define GRID_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+	int CountValueScalar(const int* values, int length, int value)
+	{
+		int count = 0;
+		for (int i = 0; i < length; i++)
+		{
+			count += values[i] == value ? 1 : 0;
+		}
+		return count;
+	}
+
+	void FindValueScalar(const int* values, int begin, int length, int value, std::vector<int>& indices)
+	{
+		for (int i = begin; i < length; i++)
+		{
+			if (values[i] == value)
+			{
+				indices.push_back(i);
+			}
+		}
+	}
+
+	void ReplaceValueScalar(int* values, int begin, int length, int from, int to, std::vector<int>& changedIndices)
+	{
+		for (int i = begin; i < length; i++)
+		{
+			if (values[i] == from)
+			{
+				values[i] = to;
+				changedIndices.push_back(i);
+			}
+		}
+	}
+
+	int ReplaceValueScalar(int* values, int begin, int length, int from, int to)
+	{
+		int count = 0;
+		for (int i = begin; i < length; i++)
+		{
+			if (values[i] == from)
+			{
+				values[i] = to;
+				count++;
+			}
+		}
+		return count;
+	}
+
+	// Appends base + the index of every set bit of mask
+	void AppendMaskIndices(unsigned mask, int base, std::vector<int>& indices)
+	{
+		for (int bit = 0; mask != 0; bit++, mask >>= 1)
+		{
+			if (mask & 1)
+			{
+				indices.push_back(base + bit);
+			}
+		}
+	}
+
+#ifdef GRID_KERNELS_X86
+	GRID_TARGET_SSE2 int CountValueSse2(const int* values, int length, int value)
+	{
+		__m128i needle = _mm_set1_epi32(value);
+		__m128i counts = _mm_setzero_si128();
+		int i = 0;
+		for (; i + 4 <= length; i += 4)
+		{
+			__m128i chunk = _mm_loadu_si128((const __m128i*)(values + i));
+			counts = _mm_sub_epi32(counts, _mm_cmpeq_epi32(chunk, needle));
+		}
+
+		alignas(16) int lanes[4];
+		_mm_store_si128((__m128i*)lanes, counts);
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3] + CountValueScalar(values + i, length - i, value);
+	}
+
+	GRID_TARGET_SSE2 void FindValueSse2(const int* values, int length, int value, std::vector<int>& indices)
+	{
+		__m128i needle = _mm_set1_epi32(value);
+		int i = 0;
+		for (; i + 4 <= length; i += 4)
+		{
+			__m128i chunk = _mm_loadu_si128((const __m128i*)(values + i));
+			unsigned mask = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(chunk, needle)));
+			AppendMaskIndices(mask, i, indices);
+		}
+		FindValueScalar(values, i, length, value, indices);
+	}
+
+	GRID_TARGET_SSE2 void ReplaceValueSse2(int* values, int length, int from, int to, std::vector<int>& changedIndices)
+	{
+		__m128i needle = _mm_set1_epi32(from);
+		__m128i replacement = _mm_set1_epi32(to);
+		int i = 0;
+		for (; i + 4 <= length; i += 4)
+		{
+			__m128i chunk = _mm_loadu_si128((const __m128i*)(values + i));
+			__m128i matches = _mm_cmpeq_epi32(chunk, needle);
+			unsigned mask = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(matches));
+			if (mask == 0) continue;
+
+			__m128i blended = _mm_or_si128(_mm_and_si128(matches, replacement), _mm_andnot_si128(matches, chunk));
+			_mm_storeu_si128((__m128i*)(values + i), blended);
+			AppendMaskIndices(mask, i, changedIndices);
+		}
+		ReplaceValueScalar(values, i, length, from, to, changedIndices);
+	}
+
+	GRID_TARGET_SSE2 int ReplaceValueSse2(int* values, int length, int from, int to)
+	{
+		__m128i needle = _mm_set1_epi32(from);
+		__m128i replacement = _mm_set1_epi32(to);
+		__m128i counts = _mm_setzero_si128();
+		int i = 0;
+		for (; i + 4 <= length; i += 4)
+		{
+			__m128i chunk = _mm_loadu_si128((const __m128i*)(values + i));
+			__m128i matches = _mm_cmpeq_epi32(chunk, needle);
+			if (_mm_movemask_ps(_mm_castsi128_ps(matches)) == 0) continue;
+
+			__m128i blended = _mm_or_si128(_mm_and_si128(matches, replacement), _mm_andnot_si128(matches, chunk));
+			_mm_storeu_si128((__m128i*)(values + i), blended);
+			counts = _mm_sub_epi32(counts, matches);
+		}
+
+		alignas(16) int lanes[4];
+		_mm_store_si128((__m128i*)lanes, counts);
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3] + ReplaceValueScalar(values, i, length, from, to);
+	}
+
+	GRID_TARGET_AVX2 int CountValueAvx2(const int* values, int length, int value)
+	{
+		__m256i needle = _mm256_set1_epi32(value);
+		__m256i counts = _mm256_setzero_si256();
+		int i = 0;
+		for (; i + 8 <= length; i += 8)
+		{
+			__m256i chunk = _mm256_loadu_si256((const __m256i*)(values + i));
+			counts = _mm256_sub_epi32(counts, _mm256_cmpeq_epi32(chunk, needle));
+		}
+
+		alignas(32) int lanes[8];
+		_mm256_store_si256((__m256i*)lanes, counts);
+		int count = 0;
+		for (int lane = 0; lane < 8; lane++)
+		{
+			count += lanes[lane];
+		}
+		return count + CountValueScalar(values + i, length - i, value);
+	}
+
+	GRID_TARGET_AVX2 void FindValueAvx2(const int* values, int length, int value, std::vector<int>& indices)
+	{
+		__m256i needle = _mm256_set1_epi32(value);
+		int i = 0;
+		for (; i + 8 <= length; i += 8)
+		{
+			__m256i chunk = _mm256_loadu_si256((const __m256i*)(values + i));
+			unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(chunk, needle)));
+			AppendMaskIndices(mask, i, indices);
+		}
+		FindValueScalar(values, i, length, value, indices);
+	}
+
+	GRID_TARGET_AVX2 void ReplaceValueAvx2(int* values, int length, int from, int to, std::vector<int>& changedIndices)
+	{
+		__m256i needle = _mm256_set1_epi32(from);
+		__m256i replacement = _mm256_set1_epi32(to);
+		int i = 0;
+		for (; i + 8 <= length; i += 8)
+		{
+			__m256i chunk = _mm256_loadu_si256((const __m256i*)(values + i));
+			__m256i matches = _mm256_cmpeq_epi32(chunk, needle);
+			unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(matches));
+			if (mask == 0) continue;
+
+			_mm256_storeu_si256((__m256i*)(values + i), _mm256_blendv_epi8(chunk, replacement, matches));
+			AppendMaskIndices(mask, i, changedIndices);
+		}
+		ReplaceValueScalar(values, i, length, from, to, changedIndices);
+	}
+
+	GRID_TARGET_AVX2 int ReplaceValueAvx2(int* values, int length, int from, int to)
+	{
+		__m256i needle = _mm256_set1_epi32(from);
+		__m256i replacement = _mm256_set1_epi32(to);
+		__m256i counts = _mm256_setzero_si256();
+		int i = 0;
+		for (; i + 8 <= length; i += 8)
+		{
+			__m256i chunk = _mm256_loadu_si256((const __m256i*)(values + i));
+			__m256i matches = _mm256_cmpeq_epi32(chunk, needle);
+			if (_mm256_movemask_ps(_mm256_castsi256_ps(matches)) == 0) continue;
+
+			_mm256_storeu_si256((__m256i*)(values + i), _mm256_blendv_epi8(chunk, replacement, matches));
+			counts = _mm256_sub_epi32(counts, matches);
+		}
+
+		alignas(32) int lanes[8];
+		_mm256_store_si256((__m256i*)lanes, counts);
+		int count = 0;
+		for (int lane = 0; lane < 8; lane++)
+		{
+			count += lanes[lane];
+		}
+		return count + ReplaceValueScalar(values, i, length, from, to);
+	}
+
+	bool DetectAvx2()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		__cpuid(info, 1);
+		bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+		bool hasAvx = (info[2] & (1 << 28)) != 0;
+		if (!osSavesYmm || !hasAvx) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+}
+
+bool GridKernels::HasAvx2()
+{
+#ifdef GRID_KERNELS_X86
+	static const bool hasAvx2 = DetectAvx2();
+	return hasAvx2;
+#else
+	return false;
+#endif
+}
+
+int GridKernels::CountValue(const int* values, int length, int value)
+{
+#ifdef GRID_KERNELS_X86
+	if (HasAvx2()) return CountValueAvx2(values, length, value);
+	return CountValueSse2(values, length, value);
+#else
+	return CountValueScalar(values, length, value);
+#endif
+}
+
+void GridKernels::FindValue(const int* values, int length, int value, std::vector<int>& indices)
+{
+#ifdef GRID_KERNELS_X86
+	if (HasAvx2())
+	{
+		FindValueAvx2(values, length, value, indices);
+		return;
+	}
+	FindValueSse2(values, length, value, indices);
+#else
+	FindValueScalar(values, 0, length, value, indices);
+#endif
+}
+
+void GridKernels::ReplaceValue(int* values, int length, int from, int to, std::vector<int>& changedIndices)
+{
+#ifdef GRID_KERNELS_X86
+	if (HasAvx2())
+	{
+		ReplaceValueAvx2(values, length, from, to, changedIndices);
+		return;
+	}
+	ReplaceValueSse2(values, length, from, to, changedIndices);
+#else
+	ReplaceValueScalar(values, 0, length, from, to, changedIndices);
+#endif
+}
+
+int GridKernels::ReplaceValue(int* values, int length, int from, int to)
+{
+#ifdef GRID_KERNELS_X86
+	if (HasAvx2()) return ReplaceValueAvx2(values, length, from, to);
+	return ReplaceValueSse2(values, length, from, to);
+#else
+	return ReplaceValueScalar(values, 0, length, from, to);
+#endif
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <vector>
+
+// Bulk kernels over a contiguous run of grid values. Each kernel picks the widest instruction
+// set available at runtime: AVX2, then SSE2, then a scalar loop.
+namespace GridKernels
+{
+	int CountValue(const int* values, int length, int value);
+	void FindValue(const int* values, int length, int value, std::vector<int>& indices);
+	void ReplaceValue(int* values, int length, int from, int to, std::vector<int>& changedIndices);
+	int ReplaceValue(int* values, int length, int from, int to);
+
+	bool HasAvx2();
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include "Structs.h"
+
+class Grid;
+
+// Interface for structures derived from a grid's content that have to stay in sync with it.
+// Observers register themselves on the grid and are notified after every changed coordinate.
+class GridObserver
+{
+public:
+	virtual ~GridObserver() {}
+
+	virtual void OnGridContentChanged(Coordinate coordinate) = 0;
+	// Called once after a bulk edit instead of once per coordinate, region bounds every changed coordinate
+	virtual void OnGridRegionChanged(Rect region) = 0;
+	virtual void DetachGrid() = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+enum class Connectivity
+{
+	Four = 0,
+	Eight = 1,
+	EightNoCornerCutting = 2
+};
+
+// The first four directions are the orthogonal neighbors in the order used by GetAdjacentValues
+// {LEFT,TOP,RIGHT,BOTTOM}, followed by the diagonals. CornerMask holds the bits of the two
+// orthogonal directions a diagonal step passes between.
+namespace NeighborOffsets
+{
+	constexpr int X[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+	constexpr int Y[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+	constexpr unsigned CornerMask[8] = { 0, 0, 0, 0, 0x3, 0x6, 0xC, 0x9 };
+	constexpr float DiagonalStep = 1.41421356f;
+}
+
+struct FourConnected
+{
+	static constexpr int Count = 4;
+	static constexpr bool CutsCorners = true;
+
+	static float Heuristic(int dx, int dy)
+	{
+		return (float)(dx + dy);
+	}
+};
+
+struct EightConnected
+{
+	static constexpr int Count = 8;
+	static constexpr bool CutsCorners = true;
+
+	static float Heuristic(int dx, int dy)
+	{
+		int diagonal = dx < dy ? dx : dy;
+		int straight = dx < dy ? dy - dx : dx - dy;
+		return straight + diagonal * NeighborOffsets::DiagonalStep;
+	}
+};
+
+struct EightConnectedNoCornerCutting
+{
+	static constexpr int Count = 8;
+	static constexpr bool CutsCorners = false;
+
+	static float Heuristic(int dx, int dy)
+	{
+		return EightConnected::Heuristic(dx, dy);
+	}
+};
+
+// Calls func(neighborIdx, direction) for every walkable neighbor of idx on a grid with a border
+// of one unwalkable cell, so no bounds checks are needed. Runs without any allocation.
+template<typename TPolicy, typename TWalkable, typename TFunc>
+inline void ForEachNeighbor(int idx, int stride, const TWalkable& walkable, TFunc&& func)
+{
+	unsigned walkableOrthogonals = 0;
+	for (int direction = 0; direction < 4; direction++)
+	{
+		int neighbor = idx + NeighborOffsets::Y[direction] * stride + NeighborOffsets::X[direction];
+		if (walkable(neighbor))
+		{
+			walkableOrthogonals |= 1u << direction;
+			func(neighbor, direction);
+		}
+	}
+	for (int direction = 4; direction < TPolicy::Count; direction++)
+	{
+		unsigned cornerMask = NeighborOffsets::CornerMask[direction];
+		if (!TPolicy::CutsCorners && (walkableOrthogonals & cornerMask) != cornerMask) continue;
+
+		int neighbor = idx + NeighborOffsets::Y[direction] * stride + NeighborOffsets::X[direction];
+		if (walkable(neighbor))
+		{
+			func(neighbor, direction);
+		}
+	}
+}
@@ -0,0 +1,84 @@
+#include "pch.h"
+#include "ReservationTable.h"
+#include <algorithm>
+
+bool ReservationTable::Reserve(int cell, int timestep, int agentId)
+{
+	auto key = ToKey(cell, timestep);
+	auto it = m_Reservations.find(key);
+	if (it != m_Reservations.end())
+	{
+		return it->second == agentId;
+	}
+
+	m_Reservations[key] = agentId;
+	m_AgentReservations[agentId].push_back(key);
+	return true;
+}
+
+int ReservationTable::GetOwner(int cell, int timestep)
+{
+	auto it = m_Reservations.find(ToKey(cell, timestep));
+	return it == m_Reservations.end() ? NoAgent : it->second;
+}
+
+bool ReservationTable::IsReservedByOther(int cell, int timestep, int agentId)
+{
+	int owner = GetOwner(cell, timestep);
+	return owner != NoAgent && owner != agentId;
+}
+
+void ReservationTable::ReleaseAgent(int agentId)
+{
+	auto agentIt = m_AgentReservations.find(agentId);
+	if (agentIt == m_AgentReservations.end()) return;
+
+	for (auto key : agentIt->second)
+	{
+		auto it = m_Reservations.find(key);
+		if (it != m_Reservations.end() && it->second == agentId)
+		{
+			m_Reservations.erase(it);
+		}
+	}
+	m_AgentReservations.erase(agentIt);
+}
+
+// Per agent key lists are pruned lazily: released keys are skipped by ReleaseAgent and the
+// lists are compacted here once an agent's reservations all lie in the past.
+void ReservationTable::ReleaseBefore(int timestep)
+{
+	auto end = m_Reservations.lower_bound(ToKey(0, timestep));
+	m_Reservations.erase(m_Reservations.begin(), end);
+
+	auto threshold = ToKey(0, timestep);
+	for (auto it = m_AgentReservations.begin(); it != m_AgentReservations.end();)
+	{
+		auto& keys = it->second;
+		keys.erase(std::remove_if(keys.begin(), keys.end(), [threshold](unsigned long long key) { return key < threshold; }), keys.end());
+		if (keys.empty())
+		{
+			it = m_AgentReservations.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+}
+
+void ReservationTable::Clear()
+{
+	m_Reservations.clear();
+	m_AgentReservations.clear();
+}
+
+int ReservationTable::Count()
+{
+	return (int)m_Reservations.size();
+}
+
+unsigned long long ReservationTable::ToKey(int cell, int timestep)
+{
+	return ((unsigned long long)(unsigned)timestep << 32) | (unsigned)cell;
+}
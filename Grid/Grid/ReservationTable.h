@@ -0,0 +1,27 @@
+#pragma once
+#include <map>
+#include <vector>
+
+// Maps (cell, timestep) pairs to the id of the agent that reserved them. Keys are ordered by
+// timestep first, so everything before a given timestep can be released in one range erase.
+class ReservationTable
+{
+public:
+	static const int NoAgent = -1;
+
+	bool Reserve(int cell, int timestep, int agentId);
+	int GetOwner(int cell, int timestep);
+	bool IsReservedByOther(int cell, int timestep, int agentId);
+
+	void ReleaseAgent(int agentId);
+	void ReleaseBefore(int timestep);
+	void Clear();
+
+	int Count();
+
+private:
+	static unsigned long long ToKey(int cell, int timestep);
+
+	std::map<unsigned long long, int> m_Reservations;
+	std::map<int, std::vector<unsigned long long>> m_AgentReservations;
+};
@@ -11,6 +11,21 @@ struct Coordinate
 	bool operator<(const Coordinate& cOther) const;
 };
 
+struct Rect
+{
+	int X;
+	int Y;
+	int Width;
+	int Height;
+};
+
+struct CellDelta
+{
+	Coordinate Position;
+	int OldValue;
+	int NewValue;
+};
+
 class Grid;
 
 struct AStarValueInfo
@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "SummedAreaTable.h"
+#include "Grid.h"
+
+// Both tables have one additional leading row and column of zeros, so the entry at (x + 1, y + 1)
+// holds the sum over [0, x] x [0, y] and every rectangle resolves to four lookups.
+SummedAreaTable::SummedAreaTable(Grid* valueGrid)
+	:ValueGrid(valueGrid)
+	,m_DirtyRow(0)
+{
+	int size = (valueGrid->Width + 1) * (valueGrid->Height + 1);
+	m_Sums.resize(size, 0);
+	m_SetCounts.resize(size, 0);
+	Rebuild();
+	ValueGrid->AddObserver(this);
+}
+
+SummedAreaTable::~SummedAreaTable()
+{
+	if (ValueGrid != nullptr)
+	{
+		ValueGrid->RemoveObserver(this);
+	}
+}
+
+long long SummedAreaTable::GetSum(int x, int y, int width, int height)
+{
+	if (!ClipRegion(x, y, width, height)) return 0;
+
+	int stride = ValueGrid->Width + 1;
+	int left = x;
+	int top = y;
+	int right = x + width;
+	int bottom = y + height;
+	return m_Sums[bottom * stride + right]
+		- m_Sums[top * stride + right]
+		- m_Sums[bottom * stride + left]
+		+ m_Sums[top * stride + left];
+}
+
+float SummedAreaTable::GetMean(int x, int y, int width, int height)
+{
+	int count = GetCount(x, y, width, height);
+	if (count == 0) return 0;
+	return (float)((double)GetSum(x, y, width, height) / count);
+}
+
+int SummedAreaTable::GetCount(int x, int y, int width, int height)
+{
+	if (!ClipRegion(x, y, width, height)) return 0;
+	return width * height;
+}
+
+int SummedAreaTable::GetSetCount(int x, int y, int width, int height)
+{
+	if (!ClipRegion(x, y, width, height)) return 0;
+
+	int stride = ValueGrid->Width + 1;
+	int left = x;
+	int top = y;
+	int right = x + width;
+	int bottom = y + height;
+	return m_SetCounts[bottom * stride + right]
+		- m_SetCounts[top * stride + right]
+		- m_SetCounts[bottom * stride + left]
+		+ m_SetCounts[top * stride + left];
+}
+
+void SummedAreaTable::Rebuild()
+{
+	m_DirtyRow = 0;
+	if (ValueGrid == nullptr) return;
+	RebuildFromRow(0);
+	m_DirtyRow = ValueGrid->Height;
+}
+
+// Edits only invalidate the rows at and below the changed coordinate. The table is rebuilt
+// lazily from the topmost invalid row on the next query, so a batch of edits costs one pass.
+void SummedAreaTable::OnGridContentChanged(Coordinate coordinate)
+{
+	if (coordinate.Y < m_DirtyRow)
+	{
+		m_DirtyRow = coordinate.Y;
+	}
+}
+
+void SummedAreaTable::OnGridRegionChanged(Rect region)
+{
+	if (region.Y < m_DirtyRow)
+	{
+		m_DirtyRow = region.Y;
+	}
+}
+
+void SummedAreaTable::DetachGrid()
+{
+	ValueGrid = nullptr;
+	m_Sums.clear();
+	m_SetCounts.clear();
+}
+
+bool SummedAreaTable::ClipRegion(int& x, int& y, int& width, int& height)
+{
+	if (ValueGrid == nullptr) return false;
+
+	int right = std::min(x + width, ValueGrid->Width);
+	int bottom = std::min(y + height, ValueGrid->Height);
+	x = std::max(x, 0);
+	y = std::max(y, 0);
+	width = right - x;
+	height = bottom - y;
+	if (width <= 0 || height <= 0) return false;
+
+	if (m_DirtyRow < bottom)
+	{
+		RebuildFromRow(m_DirtyRow);
+		m_DirtyRow = ValueGrid->Height;
+	}
+	return true;
+}
+
+void SummedAreaTable::RebuildFromRow(int row)
+{
+	int width = ValueGrid->Width;
+	int stride = width + 1;
+	int defaultValue = ValueGrid->DefaultValue;
+	for (int y = row; y < ValueGrid->Height; y++)
+	{
+		long long rowSum = 0;
+		int rowSetCount = 0;
+		for (int x = 0; x < width; x++)
+		{
+			int value = ValueGrid->GetGridContent({ x, y });
+			rowSum += value;
+			rowSetCount += value != defaultValue ? 1 : 0;
+
+			int idx = (y + 1) * stride + x + 1;
+			m_Sums[idx] = m_Sums[idx - stride] + rowSum;
+			m_SetCounts[idx] = m_SetCounts[idx - stride] + rowSetCount;
+		}
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "GridObserver.h"
+#include "Structs.h"
+#include <vector>
+
+class Grid;
+
+class SummedAreaTable : public GridObserver
+{
+public:
+	SummedAreaTable(Grid* valueGrid);
+	~SummedAreaTable();
+
+	long long GetSum(int x, int y, int width, int height);
+	float GetMean(int x, int y, int width, int height);
+	int GetCount(int x, int y, int width, int height);
+	int GetSetCount(int x, int y, int width, int height);
+
+	void Rebuild();
+	void OnGridContentChanged(Coordinate coordinate) override;
+	void OnGridRegionChanged(Rect region) override;
+	void DetachGrid() override;
+
+	Grid* ValueGrid;
+
+private:
+	bool ClipRegion(int& x, int& y, int& width, int& height);
+	void RebuildFromRow(int row);
+
+	int m_DirtyRow;
+	std::vector<long long> m_Sums;
+	std::vector<int> m_SetCounts;
+};
@@ -0,0 +1,42 @@
+#include "pch.h"
+#include "ValueSet.h"
+#include <algorithm>
+#include <stddef.h>
+
+namespace
+{
+	const long long c_MaxTableSize = 1 << 16;
+}
+
+ValueSet::ValueSet(const std::vector<int>& values, int excludedValue)
+	:m_UseTable(false)
+	,m_Min(0)
+{
+	for (auto value : values)
+	{
+		if (value != excludedValue)
+		{
+			m_Sorted.push_back(value);
+		}
+	}
+	std::sort(m_Sorted.begin(), m_Sorted.end());
+	m_Sorted.erase(std::unique(m_Sorted.begin(), m_Sorted.end()), m_Sorted.end());
+
+	if (m_Sorted.empty()) return;
+
+	long long range = (long long)m_Sorted.back() - m_Sorted.front() + 1;
+	if (range > c_MaxTableSize) return;
+
+	m_UseTable = true;
+	m_Min = m_Sorted.front();
+	m_Table.resize((size_t)range, 0);
+	for (auto value : m_Sorted)
+	{
+		m_Table[value - m_Min] = 1;
+	}
+}
+
+bool ValueSet::ContainsSorted(int value) const
+{
+	return std::binary_search(m_Sorted.begin(), m_Sorted.end(), value);
+}
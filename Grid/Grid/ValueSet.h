@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+
+// Set of grid values with constant time lookup. Values spanning a small range are tested
+// against a lookup table, wider spreads fall back to a binary search over the sorted values.
+class ValueSet
+{
+public:
+	ValueSet(const std::vector<int>& values, int excludedValue);
+
+	bool Contains(int value) const
+	{
+		if (m_UseTable)
+		{
+			unsigned offset = (unsigned)value - (unsigned)m_Min;
+			return offset < m_Table.size() && m_Table[offset] != 0;
+		}
+		return ContainsSorted(value);
+	}
+
+private:
+	bool ContainsSorted(int value) const;
+
+	bool m_UseTable;
+	int m_Min;
+	std::vector<unsigned char> m_Table;
+	std::vector<int> m_Sorted;
+};
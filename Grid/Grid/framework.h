@@ -1,5 +1,6 @@
 #pragma once
 
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
+#define NOMINMAX                        // Keep std::min and std::max usable
 // Windows Header Files
 #include <windows.h>